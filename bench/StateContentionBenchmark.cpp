@@ -0,0 +1,248 @@
+// Copyright (c) embedded ocean GmbH
+
+// A stress test for the data block containing the state of a microservice instance.
+//
+// A writer thread commits state updates the same way Instance::updateState() does, while a growing number of reader
+// threads read the state at the same time, like HMI, OPC UA or MQTT clients polling the attributes. The test is run
+// with the error message stored in a std::string, like in Instance::State, and with the error message stored in a
+// fixed-size character array. For each combination, the commit latency of the writer and the throughput of the
+// readers are printed.
+//
+// Usage: state-contention-benchmark [commits per run] [maximum number of readers]
+
+#include <xentara/memory/Array.hpp>
+#include <xentara/memory/memoryResources.hpp>
+#include <xentara/memory/ReadSentinel.hpp>
+#include <xentara/memory/WriteSentinel.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using namespace std::literals;
+using namespace xentara;
+
+// The error message the writer alternates with an empty message. This is too long for the small string
+// optimization, so that copying a std::string containing it allocates.
+constexpr auto kError = "the microservice instance could not read the quality of one of its inputs"sv;
+
+// A state that stores the error message in a std::string, like the state of the microservice
+struct StringState final
+{
+	// Sets the error message
+	auto setError(std::string_view error) -> void
+	{
+		_error.assign(error);
+	}
+
+	// Gets the error message
+	auto error() const noexcept -> std::string_view
+	{
+		return _error;
+	}
+
+	// Whether the microservice is being executed correctly
+	bool _executionState { false };
+	// The last time the microservice was executed
+	std::chrono::system_clock::time_point _executionTime {};
+	// The error message
+	std::string _error;
+};
+
+// A state that stores the error message in a fixed-size array, so that it never allocates
+struct FixedState final
+{
+	// Sets the error message, truncating it if necessary
+	auto setError(std::string_view error) noexcept -> void
+	{
+		_errorSize = error.copy(_error.data(), _error.size());
+	}
+
+	// Gets the error message
+	auto error() const noexcept -> std::string_view
+	{
+		return { _error.data(), _errorSize };
+	}
+
+	// Whether the microservice is being executed correctly
+	bool _executionState { false };
+	// The last time the microservice was executed
+	std::chrono::system_clock::time_point _executionTime {};
+	// The error message
+	std::array<char, 128> _error {};
+	// The length of the error message
+	std::size_t _errorSize { 0 };
+};
+
+// The results of a single run
+struct Result final
+{
+	// The average commit latency in microseconds
+	double _meanLatency { 0 };
+	// The median commit latency in microseconds
+	double _medianLatency { 0 };
+	// The 99th percentile of the commit latency in microseconds
+	double _p99Latency { 0 };
+	// The highest commit latency in microseconds
+	double _maxLatency { 0 };
+	// The total number of reads per second of all readers together
+	double _readsPerSecond { 0 };
+};
+
+// Converts a duration to microseconds
+auto toMicroseconds(std::chrono::steady_clock::duration duration) -> double
+{
+	return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+// Runs the writer against the given number of readers
+template <typename State>
+auto run(std::size_t readerCount, std::size_t commitCount) -> Result
+{
+	// Create the data block
+	memory::ObjectBlock<State> block;
+	block.create(memory::memoryResources::data());
+
+	// Start the readers. They copy the complete state, like a client reading all the attributes.
+	std::atomic<bool> running { true };
+	std::atomic<std::uint64_t> totalReads { 0 };
+	std::atomic<std::size_t> checksum { 0 };
+	std::vector<std::jthread> readers;
+	readers.reserve(readerCount);
+	for (std::size_t index = 0; index < readerCount; ++index)
+	{
+		readers.emplace_back([&] {
+			std::uint64_t reads = 0;
+			std::size_t sum = 0;
+			while (running.load(std::memory_order_relaxed))
+			{
+				memory::ReadSentinel sentinel { block };
+				const State state = *sentinel;
+				sum += state.error().size() + (state._executionState ? 1 : 0);
+				++reads;
+			}
+			totalReads.fetch_add(reads, std::memory_order_relaxed);
+			// Use the result, so the reads are not optimized away
+			checksum.fetch_add(sum, std::memory_order_relaxed);
+		});
+	}
+
+	// Commit the updates, alternating between success and failure, so the error message changes every time
+	std::vector<std::chrono::steady_clock::duration> latencies(commitCount);
+	const auto start = std::chrono::steady_clock::now();
+	for (std::size_t index = 0; index < commitCount; ++index)
+	{
+		const auto commitStart = std::chrono::steady_clock::now();
+
+		memory::WriteSentinel sentinel { block };
+		auto &state = *sentinel;
+		const auto timeStamp = std::chrono::system_clock::now();
+		state._executionState = index % 2 == 0;
+		state._executionTime = timeStamp;
+		state.setError(index % 2 == 0 ? ""sv : kError);
+		sentinel.commit(timeStamp);
+
+		latencies[index] = std::chrono::steady_clock::now() - commitStart;
+	}
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+
+	// Stop the readers
+	running.store(false, std::memory_order_relaxed);
+	readers.clear();
+
+	// Evaluate the latencies
+	Result result;
+	std::ranges::sort(latencies);
+	std::chrono::steady_clock::duration total { 0 };
+	for (const auto latency : latencies)
+	{
+		total += latency;
+	}
+	result._meanLatency = toMicroseconds(total) / static_cast<double>(commitCount);
+	result._medianLatency = toMicroseconds(latencies[commitCount / 2]);
+	result._p99Latency = toMicroseconds(latencies[commitCount * 99 / 100]);
+	result._maxLatency = toMicroseconds(latencies.back());
+	result._readsPerSecond =
+		static_cast<double>(totalReads.load()) / std::chrono::duration<double>(elapsed).count();
+
+	return result;
+}
+
+// Parses a positive number from the command line. Throws an exception on error.
+auto parseCount(std::string_view text) -> std::size_t
+{
+	std::size_t count {};
+	const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), count);
+	if (error != std::errc() || end != text.data() + text.size() || count == 0)
+	{
+		throw std::runtime_error(std::format(R"("{}" is not a positive number)", text));
+	}
+
+	return count;
+}
+
+// Runs the writer against each of the given numbers of readers, and prints the results
+template <typename State>
+auto runAll(std::string_view name, const std::vector<std::size_t> &readerCounts, std::size_t commitCount) -> void
+{
+	for (const auto readerCount : readerCounts)
+	{
+		const auto result = run<State>(readerCount, commitCount);
+		std::cout << std::format("{:<8} {:>7} {:>12.3f} {:>12.3f} {:>12.3f} {:>12.3f} {:>16.0f}\n",
+			name,
+			readerCount,
+			result._meanLatency,
+			result._medianLatency,
+			result._p99Latency,
+			result._maxLatency,
+			result._readsPerSecond);
+	}
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int
+{
+	try
+	{
+		// Get the parameters
+		const auto commitCount = argc > 1 ? parseCount(argv[1]) : std::size_t(100000);
+		const auto maxReaders =
+			argc > 2 ? parseCount(argv[2]) : std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+		// Use 0, 1, 2, 4 ... readers, ending with the maximum
+		std::vector<std::size_t> readerCounts { 0 };
+		for (std::size_t readerCount = 1; readerCount < maxReaders; readerCount *= 2)
+		{
+			readerCounts.push_back(readerCount);
+		}
+		readerCounts.push_back(maxReaders);
+
+		std::cout << std::format("{:<8} {:>7} {:>12} {:>12} {:>12} {:>12} {:>16}\n",
+			"error", "readers", "mean [us]", "median [us]", "p99 [us]", "max [us]", "reads/s");
+		runAll<StringState>("string"sv, readerCounts, commitCount);
+		runAll<FixedState>("fixed"sv, readerCounts, commitCount);
+	}
+	catch (const std::exception &exception)
+	{
+		std::cerr << "error: " << exception.what() << '\n';
+		return 1;
+	}
+
+	return 0;
+}
@@ -14,5 +14,22 @@ using namespace std::literals;
 const model::Attribute kExecutionState { "8270cec1-050b-499c-b03f-6bcc41dad49e"_uuid, "executionState"sv, model::Attribute::Access::ReadOnly, data::DataType::kBoolean };
 const model::Attribute kExecutionTime { "8270cec1-050b-499c-b03f-6bcc41dad49e"_uuid, "executionTime"sv, model::Attribute::Access::ReadOnly, data::DataType::kTimeStamp };
 const model::Attribute kError { model::Attribute::kError, model::Attribute::Access::ReadOnly, data::DataType::kString };
+const model::Attribute kInputsHeld { "f17343bc-d724-483d-8845-4573772467d8"_uuid, "inputsHeld"sv, model::Attribute::Access::ReadOnly, data::DataType::kBoolean };
+const model::Attribute kInputHolds { "6677b191-e0cd-4458-8994-fc8a10bd6356"_uuid, "inputHolds"sv, model::Attribute::Access::ReadOnly, data::DataType::kUInteger64 };
+const model::Attribute kInputHoldExpirations { "36060b38-8526-4726-91bf-68a0378c8ec6"_uuid, "inputHoldExpirations"sv, model::Attribute::Access::ReadOnly, data::DataType::kUInteger64 };
+const model::Attribute kInputCacheHits { "48aad7d6-72c1-4609-8cad-1ede248d9129"_uuid, "inputCacheHits"sv, model::Attribute::Access::ReadOnly, data::DataType::kUInteger64 };
+const model::Attribute kInputCacheMisses { "34f94004-d8d7-47a0-9a2b-50545a0288a7"_uuid, "inputCacheMisses"sv, model::Attribute::Access::ReadOnly, data::DataType::kUInteger64 };
+const model::Attribute kMemoryUsage { "ba695d9b-8992-4a12-ad30-aeb896bd7f9d"_uuid, "memoryUsage"sv, model::Attribute::Access::ReadOnly, data::DataType::kUInteger64 };
+const model::Attribute kMemoryAllocations { "329d512f-5572-4eeb-9287-f54061f1cd8a"_uuid, "memoryAllocations"sv, model::Attribute::Access::ReadOnly, data::DataType::kUInteger64 };
+const model::Attribute kMemoryHighWaterMark { "c4749a8a-cec4-4177-b493-6bdd6ef984d6"_uuid, "memoryHighWaterMark"sv, model::Attribute::Access::ReadOnly, data::DataType::kUInteger64 };
+const model::Attribute kOperationalAllocations { "3889aeab-fb9d-43e7-b40d-4387619c506e"_uuid, "operationalAllocations"sv, model::Attribute::Access::ReadOnly, data::DataType::kUInteger64 };
+const model::Attribute kShadowDivergences { "4526057d-c91e-4ce1-b04b-20c105711e3e"_uuid, "shadowDivergences"sv, model::Attribute::Access::ReadOnly, data::DataType::kUInteger64 };
+const model::Attribute kShadowMaxDeviation { "5c95553c-8acd-4122-8075-fac16f04a725"_uuid, "shadowMaxDeviation"sv, model::Attribute::Access::ReadOnly, data::DataType::kFloat64 };
+const model::Attribute kShadowCostRatio { "5484393f-1e0f-4bab-a154-173c8c6f0a85"_uuid, "shadowCostRatio"sv, model::Attribute::Access::ReadOnly, data::DataType::kFloat64 };
+const model::Attribute kSuspendDuration { "3d5e05f7-7c70-4c5f-bc93-d8af19736740"_uuid, "suspendDuration"sv, model::Attribute::Access::ReadOnly, data::DataType::kFloat64 };
+const model::Attribute kParameterReloads { "e5aedc75-1d3f-4f3e-a0fb-29ebf99ab1c9"_uuid, "parameterReloads"sv, model::Attribute::Access::ReadOnly, data::DataType::kUInteger64 };
+const model::Attribute kParameterReloadErrors { "be30dc0f-b026-4a25-a433-4b6beb0ddf92"_uuid, "parameterReloadErrors"sv, model::Attribute::Access::ReadOnly, data::DataType::kUInteger64 };
+const model::Attribute kStateCommitLatency { "ccc26b12-5b2d-4e8b-a2d6-edf5ff93a073"_uuid, "stateCommitLatency"sv, model::Attribute::Access::ReadOnly, data::DataType::kFloat64 };
+const model::Attribute kMaxStateCommitLatency { "8e94ce25-bb39-45e5-ac30-a891c1c93290"_uuid, "maxStateCommitLatency"sv, model::Attribute::Access::ReadOnly, data::DataType::kFloat64 };
 
 } // namespace xentara::samples::simpleMicroservice::attributes
@@ -13,5 +13,39 @@ extern const model::Attribute kExecutionState;
 extern const model::Attribute kExecutionTime;
 // A Xentara attribute containing an error message for a microservice
 extern const model::Attribute kError;
+// A Xentara attribute containing whether any input of a microservice currently uses its last good value
+extern const model::Attribute kInputsHeld;
+// A Xentara attribute containing the number of times an input of a microservice started using its last good value
+extern const model::Attribute kInputHolds;
+// A Xentara attribute containing the number of times an input of a microservice held its last good value for too long
+extern const model::Attribute kInputHoldExpirations;
+// A Xentara attribute containing the number of input reads that were served from the input cache
+extern const model::Attribute kInputCacheHits;
+// A Xentara attribute containing the number of input reads that had to fetch the value from the source
+extern const model::Attribute kInputCacheMisses;
+// A Xentara attribute containing the number of bytes a microservice currently has allocated
+extern const model::Attribute kMemoryUsage;
+// A Xentara attribute containing the number of memory blocks a microservice currently has allocated
+extern const model::Attribute kMemoryAllocations;
+// A Xentara attribute containing the highest number of bytes a microservice ever had allocated
+extern const model::Attribute kMemoryHighWaterMark;
+// A Xentara attribute containing the number of allocations a microservice made while operational
+extern const model::Attribute kOperationalAllocations;
+// A Xentara attribute containing the number of executions where the shadow kernel diverged from the primary kernel
+extern const model::Attribute kShadowDivergences;
+// A Xentara attribute containing the largest deviation between the shadow kernel and the primary kernel
+extern const model::Attribute kShadowMaxDeviation;
+// A Xentara attribute containing the execution time of the shadow kernel relative to the primary kernel
+extern const model::Attribute kShadowCostRatio;
+// A Xentara attribute containing the time in seconds it took to suspend a microservice the last time
+extern const model::Attribute kSuspendDuration;
+// A Xentara attribute containing the time in microseconds it took to commit the previous state update of a microservice
+extern const model::Attribute kStateCommitLatency;
+// A Xentara attribute containing the number of times new parameters were applied to a microservice
+extern const model::Attribute kParameterReloads;
+// A Xentara attribute containing the number of times the parameter file of a microservice could not be loaded
+extern const model::Attribute kParameterReloadErrors;
+// A Xentara attribute containing the longest time in microseconds it ever took to commit a state update
+extern const model::Attribute kMaxStateCommitLatency;
 
 } // namespace xentara::samples::simpleMicroservice::attributes
@@ -15,4 +15,6 @@ const process::Event::Role kExecuted { "47d0e52c-98e2-44ad-a63a-c90799b8b6ce"_uu
 
 const process::Event::Role kExecutionError { "5fc3a10f-460e-4319-a692-f1d3bb649b87"_uuid, "executionError"sv };
 
+const process::Event::Role kSuspendTimeout { "d05c2ac2-60bd-487a-91c4-abe115cf0471"_uuid, "suspendTimeout"sv };
+
 } // namespace xentara::samples::simpleMicroservice::events
\ No newline at end of file
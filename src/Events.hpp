@@ -10,5 +10,7 @@ namespace xentara::samples::simpleMicroservice::events
 extern const process::Event::Role kExecuted;
 // A Xentara event that is raised an error occurs executing the microservice
 extern const process::Event::Role kExecutionError;
+// A Xentara event that is raised when suspending the microservice did not complete within the configured timeout
+extern const process::Event::Role kSuspendTimeout;
 
 } // namespace xentara::samples::simpleMicroservice::events
\ No newline at end of file
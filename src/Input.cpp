@@ -1,8 +1,14 @@
 // Copyright (c) embedded ocean GmbH
 #include "Input.hpp"
 
+#include "InputCache.hpp"
+#include "Instance.hpp"
+
+#include <xentara/config/Errors.hpp>
 #include <xentara/data/Quality.hpp>
 #include <xentara/model/Attribute.hpp>
+#include <xentara/utils/json/decoder/Errors.hpp>
+#include <xentara/utils/json/decoder/Object.hpp>
 
 #include <format>
 #include <functional>
@@ -13,12 +19,45 @@ namespace xentara::samples::simpleMicroservice
 
 auto Input::load(utils::json::decoder::Value &value, config::Context &context) -> void
 {
-	// Just submit a request
-	context.resolve<model::Element>(value, std::ref(_element));
+	// A plain reference
+	if (!value.isObject())
+	{
+		// Just submit a request
+		context.resolve<model::Element>(value, std::ref(_element));
+		return;
+	}
+
+	// Go through all the members of the JSON object
+	bool elementLoaded = false;
+	auto jsonObject = value.asObject();
+	for (auto && [name, member] : jsonObject)
+	{
+		if (name == "element")
+		{
+			context.resolve<model::Element>(member, std::ref(_element));
+			elementLoaded = true;
+		}
+		else if (name == "holdTime")
+		{
+			_holdTime = std::chrono::milliseconds(member.asNumber<std::chrono::milliseconds::rep>());
+		}
+		else
+		{
+			config::throwUnknownParameterError(name);
+		}
+	}
+
+	// Make sure we got an element
+	if (!elementLoaded)
+	{
+		utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("no element specified for input"));
+	}
 }
 
-auto Input::prepare() -> void
+auto Input::prepare(trace::NameId traceName) -> void
 {
+	_traceName = traceName;
+
 	// Make sure the element was actually loaded
 	auto element = _element.lock();
 	if (!element)
@@ -26,9 +65,17 @@ auto Input::prepare() -> void
 		return;
 	}
 
+	// If we reference another microservice instance, we use its result directly and don't need any handles
+	_upstream = dynamic_cast<Instance *>(element.get());
+	if (_upstream)
+	{
+		return;
+	}
+
 	// Resolve the handles
 	_value = readHandle(*element, model::Attribute::kValue.name());
 	_quality = readHandle(*element, model::Attribute::kQuality.name());
+	_source = element.get();
 
 	// Make sure the value is not write only
 	if (_value == data::ReadHandle::Error::WriteOnly)
@@ -37,6 +84,12 @@ auto Input::prepare() -> void
 	}
 }
 
+auto Input::isReadable(const model::Element &element) -> bool
+{
+	const auto handle = element.attributeReadHandle(model::Attribute::kValue.name());
+	return handle != data::ReadHandle::Error::Unknown && handle != data::ReadHandle::Error::WriteOnly;
+}
+
 auto Input::readHandle(const model::Element &element, std::string_view attributeName) -> data::ReadHandle
 {
 	// Get the handle
@@ -51,6 +104,18 @@ auto Input::readHandle(const model::Element &element, std::string_view attribute
 	return handle;
 }
 
+auto Input::upstream() const -> Instance *
+{
+	// Get the element
+	auto element = _element.lock();
+	if (!element)
+	{
+		return nullptr;
+	}
+
+	return dynamic_cast<Instance *>(element.get());
+}
+
 auto Input::elementName() const -> std::string
 {
 	using namespace std::literals;
@@ -67,6 +132,13 @@ auto Input::elementName() const -> std::string
 
 auto Input::checkQuality() -> void
 {
+	// Chained inputs can only be read as a number
+	if (_upstream)
+	{
+		throw std::runtime_error(
+			std::format("{} is a microservice instance and can only be read as a number", elementName()));
+	}
+
 	// Read the quality
 	auto quality = _quality.read<data::Quality>();
 	if (!quality)
@@ -75,10 +147,198 @@ auto Input::checkQuality() -> void
 	}
 
 	// Check it
-	if (*quality > data::Quality::Acceptable)
+	checkQuality(*quality);
+}
+
+auto Input::checkQuality(data::Quality quality) -> void
+{
+	if (quality > data::Quality::Acceptable)
+	{
+		throw std::runtime_error(std::format("quality of {} is {}", elementName(), quality));
+	}
+}
+
+auto Input::read(std::chrono::system_clock::time_point timeStamp) -> double
+{
+	// Without a hold policy, just read the value
+	if (!_holdTime)
+	{
+		return fetch(timeStamp);
+	}
+
+	try
+	{
+		const auto value = fetch(timeStamp);
+		_lastGoodValue = value;
+		acceptValue(timeStamp);
+		return value;
+	}
+	catch (...)
+	{
+		// Fail if we may not use the last good value
+		if (!mayHold(timeStamp))
+		{
+			throw;
+		}
+	}
+
+	return _lastGoodValue;
+}
+
+auto Input::readArray(std::chrono::system_clock::time_point timeStamp) -> std::span<const double>
+{
+	// Without a hold policy, just read the value
+	if (!_holdTime)
+	{
+		return fetchArray(timeStamp);
+	}
+
+	try
+	{
+		const auto values = fetchArray(timeStamp);
+		acceptValue(timeStamp);
+		return values;
+	}
+	catch (...)
+	{
+		// Fail if we may not use the last good value
+		if (!mayHold(timeStamp))
+		{
+			throw;
+		}
+	}
+
+	// The buffer still contains the last good value, because it is only replaced after a successful read
+	return _values;
+}
+
+auto Input::acceptValue(std::chrono::system_clock::time_point timeStamp) noexcept -> void
+{
+	_lastGoodTime = timeStamp;
+	_holding = false;
+}
+
+auto Input::mayHold(std::chrono::system_clock::time_point timeStamp) noexcept -> bool
+{
+	// Chained inputs rely on the hold policy of the upstream instance, and we can't hold if we never had a good value
+	if (_upstream || !_lastGoodTime)
+	{
+		return false;
+	}
+
+	// Check if the hold time has expired
+	if (timeStamp - *_lastGoodTime > *_holdTime)
+	{
+		if (_holding)
+		{
+			_holding = false;
+			++_holdExpirations;
+		}
+		return false;
+	}
+
+	// Start holding, if we are not doing so already
+	if (!_holding)
+	{
+		_holding = true;
+		++_holds;
+	}
+	return true;
+}
+
+auto Input::fetch(std::chrono::system_clock::time_point timeStamp) -> double
+{
+	// Chained inputs get the result directly from the upstream instance
+	if (_upstream)
+	{
+		const auto values = _upstream->chainedResult(timeStamp);
+		if (values.size() != 1)
+		{
+			throw std::runtime_error(std::format("{} produces an array, not a single value", elementName()));
+		}
+
+		return values.front();
+	}
+
+	// Make sure we have a source
+	if (!_source)
+	{
+		throw std::runtime_error(std::format("{} was not resolved", elementName()));
+	}
+
+	// Look up the source in the cache
+	auto [entry, hit] = [&] {
+		trace::Span span(_traceName, trace::Phase::CacheLookup);
+		return InputCache::threadLocal().lookup(*_source, timeStamp);
+	}();
+	if (hit)
+	{
+		++_cacheHits;
+	}
+	else
+	{
+		++_cacheMisses;
+
+		// Fetch the quality and the value, remembering any errors for the other readers
+		{
+			trace::Span span(_traceName, trace::Phase::QualityRead);
+			const auto quality = _quality.read<data::Quality>();
+			entry._qualityError = quality ? std::error_code() : quality.error();
+			entry._quality = quality ? *quality : data::Quality {};
+		}
+		{
+			trace::Span span(_traceName, trace::Phase::ValueRead);
+			const auto value = _value.read<double>();
+			entry._valueError = value ? std::error_code() : value.error();
+			entry._value = value ? *value : 0.0;
+		}
+	}
+
+	// Check the quality
+	if (entry._qualityError)
+	{
+		throw std::system_error(entry._qualityError, std::format("could not read quality of {}", elementName()));
+	}
+	checkQuality(entry._quality);
+
+	// Check the value
+	if (entry._valueError)
+	{
+		handleReadError(entry._valueError);
+	}
+
+	return entry._value;
+}
+
+auto Input::fetchArray(std::chrono::system_clock::time_point timeStamp) -> std::span<const double>
+{
+	// Chained inputs use the result buffer of the upstream instance directly
+	if (_upstream)
+	{
+		return _upstream->chainedResult(timeStamp);
+	}
+
+	// Check the quality first
+	{
+		trace::Span span(_traceName, trace::Phase::QualityRead);
+		checkQuality();
+	}
+
+	trace::Span span(_traceName, trace::Phase::ValueRead);
+
+	// Try to read the value
+	auto value = _value.read<std::vector<double>>();
+	// Check it
+	if (!value)
 	{
-		throw std::runtime_error(std::format("quality of {} is {}", elementName(), *quality));
+		handleReadError(value.error());
 	}
+
+	// The read handle can only return a new vector, so the read itself allocates in every cycle. Copy the elements into
+	// our own buffer, which only grows if the size of the array changes.
+	const auto &values = *value;
+	_values.assign(values.begin(), values.end());
+	return _values;
 }
 
 auto Input::handleReadError(std::error_code error) -> void
@@ -1,33 +1,124 @@
 // Copyright (c) embedded ocean GmbH
 #pragma once
 
+#include "Trace.hpp"
+
 #include <xentara/config/Context.hpp>
+#include <xentara/data/Quality.hpp>
 #include <xentara/data/ReadHandle.hpp>
 #include <xentara/model/Element.hpp>
 #include <xentara/utils/json/decoder/Value.hpp>
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace xentara::samples::simpleMicroservice
 {
 
-// A single input of the microservice
+class Instance;
+
+// A single input of the microservice. The input can either reference an element with a value attribute, or another
+// microservice instance, in which case the result of that instance is used directly.
+//
+// An input can be configured to hold its last good value for a certain time if the element has a bad quality or cannot
+// be read, so that intermittent errors do not cause the microservice to fail.
 class Input final
 {
 public:
-	// Loads the input from a configuration value
+	// Creates an input that allocates its buffers from the given memory resource
+	explicit Input(std::pmr::memory_resource *memoryResource = std::pmr::get_default_resource()) :
+		_values(memoryResource)
+	{
+	}
+
+	// Loads the input from a configuration value. The value can either be an element reference, or an object containing
+	// the element reference and the hold policy.
 	auto load(utils::json::decoder::Value &value, config::Context &context) -> void;
 
-	// Prepares the input
-	auto prepare() -> void;
+	// Sets the element directly instead of loading it from the configuration. This must be done before the input is
+	// prepared.
+	auto setElement(std::weak_ptr<model::Element> element) -> void
+	{
+		_element = std::move(element);
+	}
+
+	// Determines whether the input has no element
+	auto empty() const noexcept -> bool
+	{
+		return _element.expired();
+	}
+
+	// Determines whether the value of an element can be read
+	static auto isReadable(const model::Element &element) -> bool;
+
+	// Prepares the input. The reads are attributed to the given name in the trace.
+	auto prepare(trace::NameId traceName) -> void;
 
 	// Reads the value as a certain type. Throws an exception on error.
 	template <typename Type>
 	auto read() -> Type;
 
+	// Reads the value as a double using the skill-wide input cache, so that the source is only read once per
+	// cycle and thread. Throws an exception on error.
+	auto read(std::chrono::system_clock::time_point timeStamp) -> double;
+
+	// Reads the value as an array of doubles. Values of chained instances are returned in place, and values of other
+	// elements are stored in a buffer owned by the input, which stays valid until the next read. Throws an exception on
+	// error.
+	auto readArray(std::chrono::system_clock::time_point timeStamp) -> std::span<const double>;
+
+	// Gets the microservice instance this input is chained to, or nullptr if it references some other element. This
+	// can be called before the input is prepared, as soon as all element references have been resolved.
+	auto upstream() const -> Instance *;
+
+	// Determines whether the input currently uses its last good value instead of the actual value
+	auto isHolding() const noexcept -> bool
+	{
+		return _holding;
+	}
+
+	// Gets the number of times the input started using its last good value
+	auto holds() const noexcept -> std::uint64_t
+	{
+		return _holds;
+	}
+
+	// Gets the number of times the input failed because it held the last good value for too long
+	auto holdExpirations() const noexcept -> std::uint64_t
+	{
+		return _holdExpirations;
+	}
+
+	// Gets the number of reads that were served from the input cache
+	auto cacheHits() const noexcept -> std::uint64_t
+	{
+		return _cacheHits;
+	}
+
+	// Gets the number of reads that had to fetch the value from the source
+	auto cacheMisses() const noexcept -> std::uint64_t
+	{
+		return _cacheMisses;
+	}
+
 private:
+	// Fetches the value as a double. Throws an exception on error.
+	auto fetch(std::chrono::system_clock::time_point timeStamp) -> double;
+	// Fetches the value as an array of doubles. Throws an exception on error.
+	auto fetchArray(std::chrono::system_clock::time_point timeStamp) -> std::span<const double>;
+
+	// Records a successful read
+	auto acceptValue(std::chrono::system_clock::time_point timeStamp) noexcept -> void;
+	// Determines whether the last good value may be used after a failed read
+	auto mayHold(std::chrono::system_clock::time_point timeStamp) noexcept -> bool;
+
 	// Gets a read handle
 	auto readHandle(const model::Element &element, std::string_view attributeName) -> data::ReadHandle;
 
@@ -36,9 +127,14 @@ private:
 	
 	// Checks the quality. Throws an exception on error.
 	auto checkQuality() -> void;
+	// Checks a quality that has already been read. Throws an exception on error.
+	auto checkQuality(data::Quality quality) -> void;
 	// Handles a read error. Always throws an exception.
 	[[noreturn]] auto handleReadError(std::error_code error) -> void;
 
+	// The name the reads are attributed to in the trace
+	trace::NameId _traceName { trace::kUnknownName };
+
 	// The element
 	std::weak_ptr<model::Element> _element;
 
@@ -46,6 +142,33 @@ private:
 	data::ReadHandle _quality;
 	// The read handle for the value
 	data::ReadHandle _value;
+
+	// The microservice instance this input is chained to, if any
+	Instance *_upstream { nullptr };
+
+	// The buffer for array values
+	std::pmr::vector<double> _values;
+
+	// The maximum time to use the last good value for, or std::nullopt to fail immediately
+	std::optional<std::chrono::milliseconds> _holdTime;
+	// The time stamp of the last successful read
+	std::optional<std::chrono::system_clock::time_point> _lastGoodTime;
+	// The last good scalar value. For arrays, the last good value remains in _values.
+	double _lastGoodValue {};
+	// Whether we are currently using the last good value
+	bool _holding { false };
+	// The number of times we started using the last good value
+	std::uint64_t _holds { 0 };
+	// The number of times the hold time expired
+	std::uint64_t _holdExpirations { 0 };
+
+	// The source element, used as key into the input cache
+	const model::Element *_source { nullptr };
+
+	// The number of reads that were served from the input cache
+	std::uint64_t _cacheHits { 0 };
+	// The number of reads that had to fetch the value from the source
+	std::uint64_t _cacheMisses { 0 };
 };
 
 template <typename Type>
@@ -0,0 +1,30 @@
+// Copyright (c) embedded ocean GmbH
+#include "InputCache.hpp"
+
+namespace xentara::samples::simpleMicroservice
+{
+
+auto InputCache::threadLocal() noexcept -> InputCache &
+{
+	thread_local InputCache cache;
+	return cache;
+}
+
+auto InputCache::lookup(const model::Element &source, std::chrono::system_clock::time_point timeStamp)
+	-> std::pair<Entry &, bool>
+{
+	// Get the entry, creating it if this is the first time we see this source on this thread
+	auto &entry = _entries[&source];
+
+	// See if it is still current
+	if (entry._timeStamp == timeStamp)
+	{
+		return { entry, true };
+	}
+
+	// Claim the entry for this cycle. The caller is responsible for filling it in.
+	entry._timeStamp = timeStamp;
+	return { entry, false };
+}
+
+} // namespace xentara::samples::simpleMicroservice
@@ -0,0 +1,54 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <xentara/data/Quality.hpp>
+#include <xentara/model/Element.hpp>
+
+#include <chrono>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+namespace xentara::samples::simpleMicroservice
+{
+
+// A cache for the values of input sources, shared by all inputs of the skill that are read on the same thread.
+//
+// Each entry is valid for a single scheduled time stamp. The first input that reads a source in a cycle fetches the
+// quality and value, and all other inputs referencing the same source get the cached copy. Sources must therefore not be
+// updated between two instances that share them within the same cycle. There is one cache per thread, so no locks or
+// atomics are needed to access it.
+class InputCache final
+{
+public:
+	// A cached entry
+	struct Entry final
+	{
+		// The scheduled time stamp the entry is valid for
+		std::chrono::system_clock::time_point _timeStamp { std::chrono::system_clock::time_point::min() };
+
+		// The error reading the quality, if any
+		std::error_code _qualityError;
+		// The quality
+		data::Quality _quality {};
+
+		// The error reading the value, if any
+		std::error_code _valueError;
+		// The value
+		double _value {};
+	};
+
+	// Gets the cache for the current thread
+	static auto threadLocal() noexcept -> InputCache &;
+
+	// Looks up the entry for a source. Returns the entry and a flag that is true if it is already valid for the given
+	// time stamp. If the flag is false, the caller must fill in the entry.
+	auto lookup(const model::Element &source, std::chrono::system_clock::time_point timeStamp)
+		-> std::pair<Entry &, bool>;
+
+private:
+	// The entries, keyed by the source element
+	std::unordered_map<const model::Element *, Entry> _entries;
+};
+
+} // namespace xentara::samples::simpleMicroservice
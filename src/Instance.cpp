@@ -3,7 +3,11 @@
 
 #include "Attributes.hpp"
 #include "Events.hpp"
+#include "Kernels.hpp"
+#include "ParameterWatcher.hpp"
+#include "SuspendGroup.hpp"
 #include "Tasks.hpp"
+#include "Trace.hpp"
 
 #include <xentara/config/Errors.hpp>
 #include <xentara/data/DataType.hpp>
@@ -19,11 +23,20 @@
 #include <xentara/process/ExecutionContext.hpp>
 #include <xentara/utils/json/decoder/Object.hpp>
 #include <xentara/utils/json/decoder/Errors.hpp>
+#include <xentara/utils/json/decoder/Value.hpp>
 #include <xentara/utils/eh/currentErrorCode.hpp>
 
 #include <algorithm>
+#include <cmath>
 #include <concepts>
+#include <cstddef>
+#include <filesystem>
 #include <format>
+#include <fstream>
+#include <system_error>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace xentara::samples::simpleMicroservice
 {
@@ -33,13 +46,35 @@ using namespace std::literals;
 const std::string_view Instance::kPendingError = "the microservice instance has not been executed yet"sv;
 const std::string_view Instance::kSuspendingError = "the microservice instance is in the process of being suspended"sv;
 const std::string_view Instance::kSuspendedError = "the microservice instance is suspended"sv;
+const std::string_view Instance::kSuspendTimeoutError =
+	"the microservice instance could not be brought into a safe state within the suspend timeout"sv;
+
+const std::chrono::milliseconds Instance::kDefaultSuspendTimeout { 10s };
+
+const std::chrono::seconds Instance::kMinimumTraceDumpInterval { 10 };
+const std::uint64_t Instance::kShadowTimingInterval { 256 };
+const std::size_t Instance::kShadowTimingBatchSize { 16 };
+
+Instance::~Instance()
+{
+	// Make sure the parameter watcher no longer accesses us
+	if (!_parameterFile.empty())
+	{
+		_parameterWatcher.get().remove(*this);
+	}
+
+	// Stop tracing
+	if (_tracing)
+	{
+		trace::disable();
+	}
+}
 
 auto Instance::load(utils::json::decoder::Object &jsonObject, config::Context &context) -> void
 {
 	// Keep track of which inputs/outputs have been loaded
 	bool leftLoaded = false;
 	bool rightLoaded = false;
-	bool setpointLoaded = false;
 	bool safeLoaded = false;
 
 	// Go through all the members of the JSON object that represents this object
@@ -58,19 +93,86 @@ auto Instance::load(utils::json::decoder::Object &jsonObject, config::Context &c
 		else if (name == "setpoint")
 		{
 			_setpoint.load(value, context);
-			setpointLoaded = true;
 		}
 		else if (name == "safe")
 		{
 			_safe.load(value, context);
 			safeLoaded = true;
 		}
+		else if (name == "isSafe")
+		{
+			_isSafe.load(value, context);
+			_isSafeLoaded = true;
+		}
+		else if (name == "suspendGroup")
+		{
+			_suspendGroupName = value.asString<std::string>();
+		}
+		else if (name == "suspendTimeout")
+		{
+			_suspendTimeout = std::chrono::milliseconds(value.asNumber<std::chrono::milliseconds::rep>());
+		}
+		else if (name == "operation")
+		{
+			// Parse the operation
+			const auto operation = kernels::parseOperation(value.asString<std::string>());
+			if (!operation)
+			{
+				utils::json::decoder::throwWithLocation(value,
+					std::runtime_error(R"(unknown operation, must be "max", "min", "add", or "scale")"));
+			}
+			_parameters._operation = *operation;
+		}
+		else if (name == "shadowOperation")
+		{
+			// Parse the operation
+			const auto operation = kernels::parseOperation(value.asString<std::string>());
+			if (!operation)
+			{
+				utils::json::decoder::throwWithLocation(value,
+					std::runtime_error(R"(unknown shadow operation, must be "max", "min", "add", or "scale")"));
+			}
+			_parameters._shadowOperation = *operation;
+		}
+		else if (name == "shadowTolerance")
+		{
+			_parameters._shadowTolerance = value.asNumber<double>();
+		}
+		else if (name == "parameterFile")
+		{
+			_parameterFile = value.asString<std::string>();
+		}
+		else if (name == "traceFile")
+		{
+			_traceFile = std::make_shared<const std::filesystem::path>(value.asString<std::string>());
+		}
+		else if (name == "traceBudget")
+		{
+			_traceBudget = std::chrono::microseconds(value.asNumber<std::chrono::microseconds::rep>());
+		}
+		else if (name == "measureStateCommit")
+		{
+			_measureStateCommit = value.asBool();
+		}
+		else if (name == "size")
+		{
+			// Get the array size
+			const auto size = value.asNumber<std::size_t>();
+			if (size == 0)
+			{
+				utils::json::decoder::throwWithLocation(value, std::runtime_error("the array size must not be 0"));
+			}
+			_size = size;
+		}
 		else
 		{
             config::throwUnknownParameterError(name);
 		}
     }
 
+	// Trace by default if there is a trace file
+	_parameters._trace = _traceFile != nullptr;
+
 	// Check that ell inputs have been loaded
 	if (!leftLoaded)
 	{
@@ -80,10 +182,6 @@ auto Instance::load(utils::json::decoder::Object &jsonObject, config::Context &c
 	{
 		utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("no right input specified for simple sample microservice instance"));
 	}
-	if (!setpointLoaded)
-	{
-		utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("no setpoint output specified for simple sample microservice instance"));
-	}
 	if (!safeLoaded)
 	{
 		utils::json::decoder::throwWithLocation(jsonObject, std::runtime_error("no safe output specified for simple sample microservice instance"));
@@ -95,24 +193,215 @@ auto Instance::performExecuteTask(const process::ExecutionContext &context) -> v
 	// Get the time stamp
 	const auto timeStamp = context.scheduledTime();
 
+	// If a chained instance already executed us in this cycle, there is nothing left to do
+	if (_result._timeStamp == timeStamp)
+	{
+		return;
+	}
+
+	// Remember the thread, so chained instances can check that they run on the same one
+	_executionThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+
+	executeCycle(timeStamp);
+}
+
+auto Instance::chainedResult(std::chrono::system_clock::time_point timeStamp) -> std::span<const double>
+{
+	// Never execute an instance whose own task is not operational, as that would revive a suspended instance
+	if (_executionStage.load(std::memory_order_relaxed) != ExecutionStage::Operational)
+	{
+		throw std::runtime_error(std::format("chained microservice {} is not operational", primaryKey()));
+	}
+	// Never execute an instance that belongs to another thread, as its data is not synchronized
+	if (_executionThread.load(std::memory_order_relaxed) != std::this_thread::get_id())
+	{
+		throw std::runtime_error(
+			std::format("chained microservice {} is executed on a different thread", primaryKey()));
+	}
+
+	// Execute first if we have not been executed in this cycle yet
+	if (_result._timeStamp != timeStamp)
+	{
+		executeCycle(timeStamp);
+	}
+
+	// Check the result
+	if (!_result._valid)
+	{
+		throw std::runtime_error(std::format("microservice {} could not be executed", primaryKey()));
+	}
+
+	return _result._values;
+}
+
+auto Instance::executeCycle(std::chrono::system_clock::time_point timeStamp) -> void
+{
+	// Pick up new parameters, if any. If nothing changed, this is a single relaxed load.
+	if (_parametersPending.load(std::memory_order_relaxed))
+	{
+		applyPendingParameters();
+	}
+
+	// Claim the cycle first, so we never execute twice with the same time stamp
+	_result._timeStamp = timeStamp;
+	_result._valid = false;
+
+	// Remember the start time if we need to check for overruns
+	const auto checkOverrun = _traceBudget && _tracing;
+	const auto start = checkOverrun ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
+	{
+		trace::Span span(_traceName, trace::Phase::Execute);
+
+		try
+		{
+			// execute the task
+			execute(timeStamp);
+			// The execution was successful
+			updateState(timeStamp);
+		}
+		catch (const std::exception &exception)
+		{
+			// Update the state
+			updateState(timeStamp, exception.what());
+		}
+	}
+
+	// Dump the trace if requested, or if we took longer than allowed
+	if (std::exchange(_traceDumpRequested, false) && _tracing)
+	{
+		_lastTraceDump.reset();
+		dumpTrace();
+	}
+	else if (checkOverrun && std::chrono::steady_clock::now() - start > *_traceBudget)
+	{
+		dumpTrace();
+	}
+}
+
+auto Instance::publishParameters(const Parameters &parameters) -> void
+{
+	// Publish the parameters first, and only then raise the flag, so that the parameters are visible once the flag is
+	// seen
+	_pendingParameters.store(std::make_shared<const Parameters>(parameters));
+	_parametersPending.store(true, std::memory_order_release);
+}
+
+auto Instance::applyPendingParameters() -> void
+{
+	// Clear the flag before taking the parameters, so that parameters published in between raise it again. Taking
+	// the parameters by exchange makes sure each set is applied only once, even if the flag is seen again.
+	_parametersPending.store(false, std::memory_order_relaxed);
+	const auto parameters = _pendingParameters.exchange(nullptr);
+	if (!parameters)
+	{
+		return;
+	}
+
+	// The shadow statistics are meaningless if the kernels changed
+	if (parameters->_operation != _parameters._operation ||
+		parameters->_shadowOperation != _parameters._shadowOperation)
+	{
+		_shadowStatistics = {};
+	}
+
+	// Changing the dump counter requests a dump
+	if (parameters->_traceDump != _parameters._traceDump)
+	{
+		_traceDumpRequested = true;
+	}
+
+	_parameters = *parameters;
+	++_parameterReloads;
+
+	// Tracing may have been switched on or off
+	updateTracing();
+}
+
+auto Instance::loadParameterFile() -> void
+{
+	// Open the file
+	std::ifstream stream(_parameterFile);
+	if (!stream)
+	{
+		throw std::runtime_error(std::format(R"(could not open parameter file "{}")", _parameterFile.string()));
+	}
+
+	// Parse it
 	try
 	{
-		// execute the task
-		execute(timeStamp);
-		// The execution was successful
-		updateState(timeStamp);
+		_parameters = parseParameters(stream, _parameters);
 	}
 	catch (const std::exception &exception)
 	{
-		// Update the state
-		updateState(timeStamp, exception.what());
+		throw std::runtime_error(
+			std::format(R"(error in parameter file "{}": {})", _parameterFile.string(), exception.what()));
 	}
 }
 
+auto Instance::dumpTrace() -> void
+{
+	// Don't dump more often than allowed, so that a series of overruns does not make things worse
+	const auto now = std::chrono::steady_clock::now();
+	if (_lastTraceDump && now - *_lastTraceDump < kMinimumTraceDumpInterval)
+	{
+		return;
+	}
+	_lastTraceDump = now;
+
+	try
+	{
+		// This only hands the trace to the writer, which writes it on its own thread
+		_traceWriter.get().dumpThread(_traceFile);
+	}
+	catch (...)
+	{
+		// The trace is only a diagnostic aid, so errors writing it must not affect the microservice
+	}
+}
+
+auto Instance::updateTracing() -> void
+{
+	// Only trace while operational, so that suspended instances don't keep tracing enabled
+	const auto tracing = _traceFile && _parameters._trace &&
+		_executionStage.load(std::memory_order_relaxed) == ExecutionStage::Operational;
+	if (tracing == _tracing)
+	{
+		return;
+	}
+
+	if (tracing)
+	{
+		trace::enable();
+	}
+	else
+	{
+		trace::disable();
+	}
+	_tracing = tracing;
+}
+
 auto Instance::prePerformExecuteTask(const process::ExecutionContext &context) -> void
 {
+	// We are no longer suspending
+	_suspendStart.reset();
+	if (_suspendGroup)
+	{
+		_suspendGroup->resume(_suspendGroupIndex);
+	}
+
+	// From now on, any allocation from our memory resource happens on the operational path
+	_memoryResource.setOperational(true);
+
 	// We are now pending
 	updateState(context.scheduledTime(), kPendingError);
+
+	// Allow chained instances to execute us from now on, but only on this thread
+	_executionThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+	_executionStage.store(ExecutionStage::Operational, std::memory_order_relaxed);
+
+	// Start tracing, if requested
+	updateTracing();
 }
 
 auto Instance::postPerformExecuteTask(const process::ExecutionContext &context) -> void
@@ -120,8 +409,25 @@ auto Instance::postPerformExecuteTask(const process::ExecutionContext &context)
 	// Get the time stamp
 	const auto timeStamp = context.scheduledTime();
 
-	// safe the state
-	const auto error = safe(timeStamp);
+	// Write out the trace of the last cycles, so it is available for inspection after shutdown
+	if (_tracing)
+	{
+		_lastTraceDump.reset();
+		dumpTrace();
+	}
+
+	// Chained instances may no longer execute us
+	_executionStage.store(ExecutionStage::Suspended, std::memory_order_relaxed);
+	// We are leaving the operational path
+	_memoryResource.setOperational(false);
+	// Stop tracing
+	updateTracing();
+
+	// Remember when we started, for the timeout and the duration
+	_suspendStart = timeStamp;
+
+	// safe the state, together with the rest of the group, if any
+	const auto error = _suspendGroup ? _suspendGroup->suspend(_suspendGroupIndex, timeStamp) : safe(timeStamp);
 	// Check for errors
 	if (error)
 	{
@@ -138,15 +444,28 @@ auto Instance::checkPostPerformExecuteTask(const process::ExecutionContext &cont
 	// Get the time stamp
 	const auto timeStamp = context.scheduledTime();
 
+	// Determine how long we have been suspending
+	const auto elapsed = timeStamp - _suspendStart.value_or(timeStamp);
+
 	try
 	{
-		// See if we are safe
-		if (isSafe())
+		// See if we are safe, using the shared check of the group, if any
+		const auto safe = _suspendGroup ? _suspendGroup->isSafe(_suspendGroupIndex, timeStamp) : isSafe();
+		if (safe)
 		{
+			_suspendDuration = elapsed;
 			updateState(timeStamp, kSuspendedError);
 			return process::Task::Status::Completed;
 		}
 
+		// Give up if we have been trying for too long
+		if (elapsed >= _suspendTimeout)
+		{
+			_suspendDuration = elapsed;
+			updateState(timeStamp, kSuspendTimeoutError, &_suspendTimeoutEvent);
+			return process::Task::Status::Completed;
+		}
+
 		return process::Task::Status::Pending;
 	}
 	catch (const std::exception &exception)
@@ -169,19 +488,27 @@ auto Instance::execute(std::chrono::system_clock::time_point timeStamp) -> void
 {
 	try
 	{
-		// See if we are in the safe mode
-		if (isSafe())
+		if (!_size)
 		{
-			// Remove the safety
-			_safe.write(false);
+			// Read the inputs
+			const auto left = _left.read(timeStamp);
+			const auto right = _right.read(timeStamp);
+
+			// Compute the set point
+			compute(std::span(&left, 1), std::span(&right, 1));
+		}
+		else
+		{
+			// Read the inputs without copying them and compute the set point
+			compute(_left.readArray(timeStamp), _right.readArray(timeStamp));
 		}
 
-		// Read the inputs
-		const auto left = _left.read<double>();
-		const auto right = _right.read<double>();
+		// Publish the result for chained instances
+		_result._valid = true;
 
-		// Use the maximum as the set point
-		_setpoint.write(std::max(left, right));
+		// Write the outputs only after all inputs have been read and the set point has been computed, so that nothing
+		// is written if any of the inputs are bad
+		writeOutputs();
 	}
 	catch (...)
 	{
@@ -192,33 +519,202 @@ auto Instance::execute(std::chrono::system_clock::time_point timeStamp) -> void
 	}
 }
 
+auto Instance::compute(std::span<const double> left, std::span<const double> right) -> void
+{
+	trace::Span span(_traceName, trace::Phase::Compute);
+
+	// Without a shadow kernel, just compute the set point directly into the preallocated result buffer
+	if (!_parameters._shadowOperation)
+	{
+		kernels::apply(_parameters._operation, left, right, _result._values);
+		return;
+	}
+
+	// Run both kernels on the same inputs
+	kernels::apply(_parameters._operation, left, right, _result._values);
+	kernels::apply(*_parameters._shadowOperation, left, right, _shadowValues);
+
+	// Time the kernels every now and then. Timing a single execution would mostly measure the clock itself.
+	if (_shadowStatistics._executions++ % kShadowTimingInterval == 0)
+	{
+		timeKernels(left, right);
+	}
+
+	// Compare the results. A NaN in either result always counts as a divergence.
+	bool diverged = false;
+	for (std::size_t index = 0; index < _result._values.size(); ++index)
+	{
+		const auto deviation = std::abs(_result._values[index] - _shadowValues[index]);
+		if (!(deviation <= _parameters._shadowTolerance))
+		{
+			diverged = true;
+		}
+		if (deviation > _shadowStatistics._maxDeviation)
+		{
+			_shadowStatistics._maxDeviation = deviation;
+		}
+	}
+	if (diverged)
+	{
+		++_shadowStatistics._divergences;
+	}
+}
+
+auto Instance::timeKernels(std::span<const double> left, std::span<const double> right) -> void
+{
+	// Execute each kernel a number of times in a row. The kernels always produce the same results for the same
+	// inputs, so the results are not affected.
+	const auto primaryStart = std::chrono::steady_clock::now();
+	for (std::size_t iteration = 0; iteration < kShadowTimingBatchSize; ++iteration)
+	{
+		kernels::apply(_parameters._operation, left, right, _result._values);
+	}
+	const auto shadowStart = std::chrono::steady_clock::now();
+	for (std::size_t iteration = 0; iteration < kShadowTimingBatchSize; ++iteration)
+	{
+		kernels::apply(*_parameters._shadowOperation, left, right, _shadowValues);
+	}
+	const auto shadowEnd = std::chrono::steady_clock::now();
+
+	_shadowStatistics._primaryTime += shadowStart - primaryStart;
+	_shadowStatistics._shadowTime += shadowEnd - shadowStart;
+}
+
+auto Instance::writeOutputs() -> void
+{
+	trace::Span span(_traceName, trace::Phase::OutputWrite);
+
+	// Write the set point to all its targets
+	if (!_size)
+	{
+		_setpoint.write(_result._values.front());
+	}
+	else if (!_setpoint.empty())
+	{
+		// Copy the result into the preallocated buffer the write handles accept
+		std::ranges::copy(_result._values, _setpointBuffer.begin());
+		_setpoint.write(_setpointBuffer);
+	}
+
+	// Remove the safety if we set it. The flag is only cleared once the write succeeded, so a failed write is retried
+	// in the next cycle.
+	if (_safeWritten)
+	{
+		_safe.write(false);
+		_safeWritten = false;
+	}
+}
+
 auto Instance::safe(std::chrono::system_clock::time_point timeStamp) -> std::error_code
 {
-	// Set the safe state
+	// Set the safe state. The flag is set even if the write fails, as it may still have reached some of the targets.
+	_safeWritten = true;
 	return _safe.write(true, std::nothrow);
 }
 
+auto Instance::checkForCycles() const -> void
+{
+	// Do a depth first search through all the instances we depend on
+	std::vector<const Instance *> pending { this };
+	std::unordered_set<const Instance *> visited;
+	while (!pending.empty())
+	{
+		const auto current = pending.back();
+		pending.pop_back();
+
+		for (const auto input : { &current->_left, &current->_right })
+		{
+			// Skip inputs that are not chained
+			const auto upstream = input->upstream();
+			if (!upstream)
+			{
+				continue;
+			}
+
+			// If we find ourselves, we have a cycle
+			if (upstream == this)
+			{
+				throw std::runtime_error(std::format(
+					"microservice {} depends on itself through chained instance {}", primaryKey(), current->primaryKey()));
+			}
+
+			// Continue with the upstream instance if we have not seen it yet
+			if (visited.insert(upstream).second)
+			{
+				pending.push_back(upstream);
+			}
+		}
+	}
+}
+
 auto Instance::isSafe() -> bool
 {
+	// If we cannot read back the safe state, we assume it was reached as soon as the safe output was written
+	if (_isSafe.empty())
+	{
+		return true;
+	}
+
 	return _isSafe.read<bool>();
 }
 
 auto Instance::updateState(
-	std::chrono::system_clock::time_point timeStamp, std::optional<std::string_view> error) -> void
+	std::chrono::system_clock::time_point timeStamp,
+	std::optional<std::string_view> error,
+	const process::Event *event) -> void
 {
+	trace::Span span(_traceName, trace::Phase::UpdateState);
+
+	// Measure the time from acquiring the data block to the end of the commit, if requested
+	const auto commitStart =
+		_measureStateCommit ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
 	// Make a write sentinel
 	memory::WriteSentinel sentinel { _stateDataBlock };
 	auto &state = *sentinel;
 
-	// Update the state
+	// Update the state. The error is assigned in place so that the existing capacity of the string is reused.
 	state._executionState = !error;
 	state._executionTime = timeStamp;
-	state._error = std::string(error.value_or(""sv));
-
-	// Determine the correct event
-	const auto &event = error ? _executionErrorEvent : _executedEvent;
+	state._error.assign(error.value_or(""sv));
+	state._inputsHeld = _left.isHolding() || _right.isHolding();
+	state._inputHolds = _left.holds() + _right.holds();
+	state._inputHoldExpirations = _left.holdExpirations() + _right.holdExpirations();
+	state._inputCacheHits = _left.cacheHits() + _right.cacheHits();
+	state._inputCacheMisses = _left.cacheMisses() + _right.cacheMisses();
+	state._memoryUsage = _heapResource.bytes();
+	state._memoryAllocations = _memoryResource.allocations();
+	state._memoryHighWaterMark = _heapResource.highWaterMark();
+	state._operationalAllocations = _memoryResource.operationalAllocations();
+	state._shadowDivergences = _shadowStatistics._divergences;
+	state._shadowMaxDeviation = _shadowStatistics._maxDeviation;
+	state._shadowCostRatio = _shadowStatistics._primaryTime.count() > 0
+		? static_cast<double>(_shadowStatistics._shadowTime.count()) /
+			static_cast<double>(_shadowStatistics._primaryTime.count())
+		: 0.0;
+
+	state._suspendDuration = std::chrono::duration<double>(_suspendDuration).count();
+	state._parameterReloads = _parameterReloads;
+	state._parameterReloadErrors = _parameterReloadErrors.load(std::memory_order_relaxed);
+
+	// The commit latencies are those of the previous update, as the current one has not been committed yet
+	state._stateCommitLatency = std::chrono::duration<double, std::micro>(_stateCommitLatency).count();
+	state._maxStateCommitLatency = std::chrono::duration<double, std::micro>(_maxStateCommitLatency).count();
+
+	// Determine the correct event, unless the caller specified one
+	if (!event)
+	{
+		event = error ? &_executionErrorEvent : &_executedEvent;
+	}
 	// Commit the data and raise the event
-	sentinel.commit(timeStamp, event);
+	sentinel.commit(timeStamp, *event);
+
+	// Remember how long it took
+	if (_measureStateCommit)
+	{
+		_stateCommitLatency = std::chrono::steady_clock::now() - commitStart;
+		_maxStateCommitLatency = std::max(_maxStateCommitLatency, _stateCommitLatency);
+	}
 }
 
 auto Instance::forEachAttribute(const model::ForEachAttributeFunction &function) const -> bool
@@ -227,7 +723,26 @@ auto Instance::forEachAttribute(const model::ForEachAttributeFunction &function)
 	return
 		function(attributes::kExecutionState) ||
 		function(attributes::kExecutionTime) ||
-		function(attributes::kError);
+		function(attributes::kError) ||
+		function(attributes::kInputsHeld) ||
+		function(attributes::kInputHolds) ||
+		function(attributes::kInputHoldExpirations) ||
+		function(attributes::kInputCacheHits) ||
+		function(attributes::kInputCacheMisses) ||
+		function(attributes::kMemoryUsage) ||
+		function(attributes::kMemoryAllocations) ||
+		function(attributes::kMemoryHighWaterMark) ||
+		function(attributes::kOperationalAllocations) ||
+		function(attributes::kSuspendDuration) ||
+		function(attributes::kParameterReloads) ||
+		function(attributes::kParameterReloadErrors) ||
+		(hasStateCommitAttributes() && (
+			function(attributes::kStateCommitLatency) ||
+			function(attributes::kMaxStateCommitLatency))) ||
+		(hasShadowAttributes() && (
+			function(attributes::kShadowDivergences) ||
+			function(attributes::kShadowMaxDeviation) ||
+			function(attributes::kShadowCostRatio)));
 }
 
 auto Instance::forEachEvent(const model::ForEachEventFunction &function) -> bool
@@ -235,7 +750,8 @@ auto Instance::forEachEvent(const model::ForEachEventFunction &function) -> bool
 	// Handle all the events we support
 	return
 		function(events::kExecuted, sharedFromThis(&_executedEvent)) ||
-		function(events::kExecutionError, sharedFromThis(&_executionErrorEvent));
+		function(events::kExecutionError, sharedFromThis(&_executionErrorEvent)) ||
+		function(events::kSuspendTimeout, sharedFromThis(&_suspendTimeoutEvent));
 }
 
 auto Instance::forEachTask(const model::ForEachTaskFunction &function) -> bool
@@ -259,6 +775,74 @@ auto Instance::makeReadHandle(const model::Attribute &attribute) const noexcept
 	{
 		return _stateDataBlock.member(&State::_error);
 	}
+	else if (attribute == attributes::kInputsHeld)
+	{
+		return _stateDataBlock.member(&State::_inputsHeld);
+	}
+	else if (attribute == attributes::kInputHolds)
+	{
+		return _stateDataBlock.member(&State::_inputHolds);
+	}
+	else if (attribute == attributes::kInputHoldExpirations)
+	{
+		return _stateDataBlock.member(&State::_inputHoldExpirations);
+	}
+	else if (attribute == attributes::kInputCacheHits)
+	{
+		return _stateDataBlock.member(&State::_inputCacheHits);
+	}
+	else if (attribute == attributes::kInputCacheMisses)
+	{
+		return _stateDataBlock.member(&State::_inputCacheMisses);
+	}
+	else if (attribute == attributes::kMemoryUsage)
+	{
+		return _stateDataBlock.member(&State::_memoryUsage);
+	}
+	else if (attribute == attributes::kMemoryAllocations)
+	{
+		return _stateDataBlock.member(&State::_memoryAllocations);
+	}
+	else if (attribute == attributes::kMemoryHighWaterMark)
+	{
+		return _stateDataBlock.member(&State::_memoryHighWaterMark);
+	}
+	else if (attribute == attributes::kOperationalAllocations)
+	{
+		return _stateDataBlock.member(&State::_operationalAllocations);
+	}
+	else if (attribute == attributes::kSuspendDuration)
+	{
+		return _stateDataBlock.member(&State::_suspendDuration);
+	}
+	else if (attribute == attributes::kParameterReloads)
+	{
+		return _stateDataBlock.member(&State::_parameterReloads);
+	}
+	else if (attribute == attributes::kParameterReloadErrors)
+	{
+		return _stateDataBlock.member(&State::_parameterReloadErrors);
+	}
+	else if (hasStateCommitAttributes() && attribute == attributes::kStateCommitLatency)
+	{
+		return _stateDataBlock.member(&State::_stateCommitLatency);
+	}
+	else if (hasStateCommitAttributes() && attribute == attributes::kMaxStateCommitLatency)
+	{
+		return _stateDataBlock.member(&State::_maxStateCommitLatency);
+	}
+	else if (hasShadowAttributes() && attribute == attributes::kShadowDivergences)
+	{
+		return _stateDataBlock.member(&State::_shadowDivergences);
+	}
+	else if (hasShadowAttributes() && attribute == attributes::kShadowMaxDeviation)
+	{
+		return _stateDataBlock.member(&State::_shadowMaxDeviation);
+	}
+	else if (hasShadowAttributes() && attribute == attributes::kShadowCostRatio)
+	{
+		return _stateDataBlock.member(&State::_shadowCostRatio);
+	}
 
 	return std::nullopt;
 }
@@ -267,15 +851,74 @@ auto Instance::realize() -> void
 {
 	// Create the data block
 	_stateDataBlock.create(memory::memoryResources::data());
+
+	// Preallocate the result buffers, so no allocation is necessary while running
+	_result._values.resize(_size.value_or(1));
+	if (_parameters._shadowOperation || !_parameterFile.empty())
+	{
+		_shadowValues.resize(_result._values.size());
+	}
+	if (_size && !_setpoint.empty())
+	{
+		_setpointBuffer.resize(*_size);
+	}
 }
 
 auto Instance::prepare() -> void
 {
+	// Make sure the chained instances form a DAG
+	checkForCycles();
+
+	// Apply the parameter file, and watch it for changes. The parameters from the model are used for everything
+	// missing from the file.
+	if (!_parameterFile.empty())
+	{
+		// Get the modification time before reading the file, so that changes made while we read it are picked up by
+		// the watcher
+		std::error_code error;
+		const auto lastWriteTime = std::filesystem::last_write_time(_parameterFile, error);
+
+		const auto modelParameters = _parameters;
+		loadParameterFile();
+
+		auto &watcher = _parameterWatcher.get();
+		watcher.add(*this, _parameterFile, modelParameters, error ? std::nullopt : std::make_optional(lastWriteTime));
+		watcher.start();
+	}
+
+	// Start the trace writer if we want a trace. Tracing itself is only enabled once we are operational.
+	if (_traceFile)
+	{
+		_traceWriter.get().start();
+	}
+
+	// Get the name for our spans. This is done even if we have no trace file, as tracing is enabled for the whole
+	// thread, so our spans may end up in the trace of another instance.
+	_traceName = trace::internName(primaryKey());
+
 	// Prepare all the inputs and outputs
-	_left.prepare();
-	_right.prepare();
+	_left.prepare(_traceName);
+	_right.prepare(_traceName);
 	_setpoint.prepare();
 	_safe.prepare();
+
+	// If no separate input was configured, read back the safe state from the safe output, if it can be read
+	if (!_isSafeLoaded)
+	{
+		const auto safeElement = _safe.firstElement();
+		if (const auto element = safeElement.lock(); element && Input::isReadable(*element))
+		{
+			_isSafe.setElement(safeElement);
+		}
+	}
+	_isSafe.prepare(_traceName);
+
+	// Join the suspend group
+	if (!_suspendGroupName.empty())
+	{
+		_suspendGroup = SuspendGroup::named(_suspendGroupName);
+		_suspendGroupIndex = _suspendGroup->add(*this);
+	}
 }
 
 auto Instance::ExecuteTask::preparePreOperational(const process::ExecutionContext &context) -> Status
@@ -291,8 +934,16 @@ auto Instance::ExecuteTask::operational(const process::ExecutionContext &context
 
 auto Instance::ExecuteTask::preparePostOperational(const process::ExecutionContext &context) -> Status
 {
-	_target.get().postPerformExecuteTask(context);
-	return Status::Completed;
+	auto &target = _target.get();
+
+	// Start suspending on the first call
+	if (!target._suspendStart)
+	{
+		target.postPerformExecuteTask(context);
+	}
+
+	// Check whether we are done
+	return target.checkPostPerformExecuteTask(context);
 }
 
 } // namespace xentara::samples::simpleMicroservice
\ No newline at end of file
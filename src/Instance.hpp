@@ -3,6 +3,10 @@
 
 #include "Attributes.hpp"
 #include "Input.hpp"
+#include "Kernels.hpp"
+#include "Parameters.hpp"
+#include "TrackingMemoryResource.hpp"
+#include "Trace.hpp"
 #include "Output.hpp"
 
 #include <xentara/memory/Array.hpp>
@@ -13,11 +17,21 @@
 #include <xentara/skill/EnableSharedFromThis.hpp>
 #include <xentara/utils/core/Uuid.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <functional>
+#include <memory>
+#include <memory_resource>
+#include <span>
 #include <string>
 #include <string_view>
 #include <optional>
 #include <new>
+#include <thread>
+#include <vector>
 
 namespace xentara::samples::simpleMicroservice
 {
@@ -25,6 +39,8 @@ namespace xentara::samples::simpleMicroservice
 using namespace std::literals;
 
 class TemplateClient;
+class SuspendGroup;
+class ParameterWatcher;
 
 // A class representing a sample microservice.
 class Instance final : public skill::Element, public skill::EnableSharedFromThis<Instance>
@@ -41,6 +57,16 @@ public:
 		// NOTE: The display name must be understandable event without knowing the skill it belongs to.
 		"simple sample microservice">;
 
+	// Creates an instance that hands its trace dumps to the given writer, and has its parameter file watched by the
+	// given watcher
+	Instance(trace::Writer &traceWriter, ParameterWatcher &parameterWatcher) :
+		_parameterWatcher(parameterWatcher), _traceWriter(traceWriter)
+	{
+	}
+
+	// Stops watching the parameter file and stops tracing, if necessary
+	~Instance();
+
 	///////////////////////////////////////////////////////
 	// Virtual overrides for skill::Element
 
@@ -57,6 +83,12 @@ public:
 		return model::ElementCategory::Microservice;
 	}
 
+	// Gets the result of the microservice for use by a chained instance, executing this instance first if it has not
+	// yet been executed for the given time stamp. For scalar instances, the result contains a single element. Throws an
+	// exception if the execution failed, if the "execute" task of this instance is not operational, or if it is
+	// executed on a different thread than the caller.
+	auto chainedResult(std::chrono::system_clock::time_point timeStamp) -> std::span<const double>;
+
 private:
 	// The error message for a microservice that has not been executed yet
 	static const std::string_view kPendingError;
@@ -64,6 +96,29 @@ private:
 	static const std::string_view kSuspendingError;
 	// The error message for a microservice that is suspended
 	static const std::string_view kSuspendedError;
+	// The error message for a microservice that could not be suspended in time
+	static const std::string_view kSuspendTimeoutError;
+
+	// The time after which we give up trying to get into a safe state, if no timeout was configured
+	static const std::chrono::milliseconds kDefaultSuspendTimeout;
+
+	// The minimum time between two trace dumps caused by overruns
+	static const std::chrono::seconds kMinimumTraceDumpInterval;
+	// The number of executions between two timings of the shadow kernel
+	static const std::uint64_t kShadowTimingInterval;
+	// The number of times each kernel is executed when timing the shadow kernel
+	static const std::size_t kShadowTimingBatchSize;
+
+	// The stage the "execute" task is in
+	enum class ExecutionStage
+	{
+		// The task has not been started yet
+		Inactive,
+		// The task is operational
+		Operational,
+		// The task is being suspended, or has been suspended
+		Suspended
+	};
 
 	// This structure represents the current state of the microservice
 	struct State final
@@ -74,6 +129,72 @@ private:
 		std::chrono::system_clock::time_point _executionTime { std::chrono::system_clock::time_point::min() };
 		// The error message, or an empty string for none.
 		std::string _error { kPendingError };
+		// Whether any of the inputs currently uses its last good value, making the result uncertain
+		bool _inputsHeld { false };
+		// The number of times an input started using its last good value
+		std::uint64_t _inputHolds { 0 };
+		// The number of times an input failed because it held its last good value for too long
+		std::uint64_t _inputHoldExpirations { 0 };
+		// The number of input reads that were served from the input cache
+		std::uint64_t _inputCacheHits { 0 };
+		// The number of input reads that had to fetch the value from the source
+		std::uint64_t _inputCacheMisses { 0 };
+		// The number of bytes the instance's memory pool currently takes from the heap
+		std::uint64_t _memoryUsage { 0 };
+		// The number of blocks currently allocated from the instance's memory resource
+		std::uint64_t _memoryAllocations { 0 };
+		// The highest number of bytes the instance's memory pool ever took from the heap
+		std::uint64_t _memoryHighWaterMark { 0 };
+		// The number of allocations from the instance's memory resource made while operational
+		std::uint64_t _operationalAllocations { 0 };
+		// The number of executions where the shadow kernel produced a different result than the primary kernel
+		std::uint64_t _shadowDivergences { 0 };
+		// The largest deviation between the results of the shadow kernel and the primary kernel
+		double _shadowMaxDeviation { 0 };
+		// The execution time of the shadow kernel relative to the primary kernel
+		double _shadowCostRatio { 0 };
+		// The time in seconds it took to suspend the microservice the last time
+		double _suspendDuration { 0 };
+		// The time in microseconds it took to commit the previous state update
+		double _stateCommitLatency { 0 };
+		// The longest time in microseconds it ever took to commit a state update
+		double _maxStateCommitLatency { 0 };
+		// The number of times new parameters were applied
+		std::uint64_t _parameterReloads { 0 };
+		// The number of times the parameter file could not be loaded
+		std::uint64_t _parameterReloadErrors { 0 };
+	};
+
+	// This structure holds the result of the last execution, for use by chained instances
+	struct Result final
+	{
+		// Creates a result whose buffer is allocated from the given memory resource
+		explicit Result(std::pmr::memory_resource *memoryResource) : _values(memoryResource)
+		{
+		}
+
+		// The time stamp of the cycle the result belongs to
+		std::chrono::system_clock::time_point _timeStamp { std::chrono::system_clock::time_point::min() };
+		// Whether the execution was successful
+		bool _valid { false };
+		// The set point computed by the execution. This buffer is preallocated, and contains a single element for
+		// scalar instances.
+		std::pmr::vector<double> _values;
+	};
+
+	// This structure contains the statistics for the shadow kernel
+	struct ShadowStatistics final
+	{
+		// The number of executions since the statistics were reset
+		std::uint64_t _executions { 0 };
+		// The number of executions where the results diverged
+		std::uint64_t _divergences { 0 };
+		// The largest deviation between the results
+		double _maxDeviation { 0 };
+		// The total execution time of the primary kernel in the timed batches
+		std::chrono::nanoseconds _primaryTime { 0 };
+		// The total execution time of the shadow kernel in the timed batches
+		std::chrono::nanoseconds _shadowTime { 0 };
 	};
 
 	// This class provides callbacks for the Xentara scheduler for the "execute" task
@@ -104,6 +225,11 @@ private:
 		std::reference_wrapper<Instance> _target;
 	};
 
+	// The suspend group accesses safe() and isSafe()
+	friend class SuspendGroup;
+	// The parameter watcher accesses publishParameters() and the reload error count
+	friend class ParameterWatcher;
+
 	// This function is called by the "execute" task on startup.
 	auto prePerformExecuteTask(const process::ExecutionContext &context) -> void;
 	// This function is called by the "execute" task.
@@ -113,16 +239,55 @@ private:
 	// This function determines if the shutdown or suspend of the "execute" task has completed.
 	auto checkPostPerformExecuteTask(const process::ExecutionContext &context) -> process::Task::Status;
 
+	// Executes the microservice for a cycle and updates the state
+	auto executeCycle(std::chrono::system_clock::time_point timeStamp) -> void;
 	// Executes the microservice. Throws an exception on error
 	auto execute(std::chrono::system_clock::time_point timeStamp) -> void;
+	// Computes the set point from the input values, and runs the shadow kernel, if any
+	auto compute(std::span<const double> left, std::span<const double> right) -> void;
+	// Times a batch of executions of the primary kernel and the shadow kernel
+	auto timeKernels(std::span<const double> left, std::span<const double> right) -> void;
+	// Writes the results of a successful execution to the outputs. Throws an exception on error
+	auto writeOutputs() -> void;
 	// Safes the state. Returns an error on error.
 	auto safe(std::chrono::system_clock::time_point timeStamp) -> std::error_code;
 
+	// Hands new parameters to the instance. They are applied before the next execution. This can be called from any
+	// thread.
+	auto publishParameters(const Parameters &parameters) -> void;
+	// Applies the parameters handed over by publishParameters(), if any
+	auto applyPendingParameters() -> void;
+	// Applies the contents of the parameter file. Throws an exception on error.
+	auto loadParameterFile() -> void;
+
+	// Determines whether the shadow attributes are present
+	auto hasShadowAttributes() const noexcept -> bool
+	{
+		return _parameters._shadowOperation || !_parameterFile.empty();
+	}
+
+	// Determines whether the state commit latency attributes are present
+	auto hasStateCommitAttributes() const noexcept -> bool
+	{
+		return _measureStateCommit;
+	}
+
+	// Hands the trace of the current thread to the trace writer, unless an overrun dump was made recently
+	auto dumpTrace() -> void;
+	// Enables or disables tracing, depending on the parameters and the stage of the "execute" task
+	auto updateTracing() -> void;
+
+	// Makes sure the instance does not depend on itself through chained inputs. Throws an exception on error.
+	auto checkForCycles() const -> void;
+
 	// Checks whether the state is safe
 	auto isSafe() -> bool;
 
-	// Updates the state
-	auto updateState(std::chrono::system_clock::time_point timeStamp, std::optional<std::string_view> error = std::nullopt) -> void;
+	// Updates the state. If no event is given, the "executed" or "executionError" event is raised, depending on the
+	// error.
+	auto updateState(std::chrono::system_clock::time_point timeStamp,
+		std::optional<std::string_view> error = std::nullopt,
+		const process::Event *event = nullptr) -> void;
 
 	///////////////////////////////////////////////////////
 	// Virtual overrides for skill::Element
@@ -137,26 +302,118 @@ private:
 	process::Event _executedEvent;
 	// A Xentara event that is raised when an error occurred executing the microservice
 	process::Event _executionErrorEvent;
+	// A Xentara event that is raised when suspending the microservice timed out
+	process::Event _suspendTimeoutEvent;
 
 	// The "execute" task
 	ExecuteTask _executeTask { *this };
+	// The stage the "execute" task is in. This is atomic, because chained instances check it.
+	std::atomic<ExecutionStage> _executionStage { ExecutionStage::Inactive };
+	// The thread the "execute" task runs on. This is atomic, because chained instances check it.
+	std::atomic<std::thread::id> _executionThread;
 
 	// The data block that contains the state
 	memory::ObjectBlock<State> _stateDataBlock;
 
+	// The memory resource that keeps track of the chunks the pool takes from the global heap. This is the actual memory
+	// footprint of the instance, including the slack in the pool.
+	TrackingMemoryResource _heapResource;
+	// The pool the instance's own data structures are allocated from, so they are kept together and freed blocks are
+	// reused without going back to the global heap. Allocations only happen while the model is loaded, and on the
+	// thread executing the instance, but never at the same time, so the pool needs no synchronization.
+	std::pmr::unsynchronized_pool_resource _memoryPool { &_heapResource };
+	// The memory resource that keeps track of the individual allocations from the pool. This must be declared before
+	// anything that uses it.
+	TrackingMemoryResource _memoryResource { &_memoryPool };
+
+	// The parameters currently in use
+	Parameters _parameters;
+	// The file the parameters are reloaded from, or an empty path for none
+	std::filesystem::path _parameterFile;
+	// The watcher that reloads the parameter file
+	std::reference_wrapper<ParameterWatcher> _parameterWatcher;
+	// New parameters handed over by the parameter watcher
+	std::atomic<std::shared_ptr<const Parameters>> _pendingParameters;
+	// Whether there may be new parameters in _pendingParameters. This is only a cheap check for the execution path,
+	// the parameters themselves are taken out of _pendingParameters.
+	std::atomic<bool> _parametersPending { false };
+	// The number of times new parameters were applied
+	std::uint64_t _parameterReloads { 0 };
+	// The number of times the parameter file could not be loaded by the parameter watcher
+	std::atomic<std::uint64_t> _parameterReloadErrors { 0 };
+
+	// The preallocated result buffer for the shadow kernel
+	std::pmr::vector<double> _shadowValues { &_memoryResource };
+	// The statistics for the shadow kernel
+	ShadowStatistics _shadowStatistics;
+
+	// The number of array elements, or std::nullopt for scalar values
+	std::optional<std::size_t> _size;
+
+	// The writer the trace dumps are handed to
+	std::reference_wrapper<trace::Writer> _traceWriter;
+	// The name our spans are attributed to in the trace
+	trace::NameId _traceName { trace::kUnknownName };
+	// The file the trace is written to, or nullptr for none. This is shared with the trace writer, so that dumps can
+	// be requested without allocating.
+	std::shared_ptr<const std::filesystem::path> _traceFile;
+	// Whether we have currently enabled tracing
+	bool _tracing { false };
+	// Whether a dump of the trace was requested using the parameters
+	bool _traceDumpRequested { false };
+	// The maximum execution time before the trace is written to the trace file
+	std::optional<std::chrono::microseconds> _traceBudget;
+	// The last time the trace was dumped
+	std::optional<std::chrono::steady_clock::time_point> _lastTraceDump;
+
+	// Whether the time it takes to commit state updates is measured
+	bool _measureStateCommit { false };
+	// The time it took to commit the last state update
+	std::chrono::steady_clock::duration _stateCommitLatency { 0 };
+	// The longest time it ever took to commit a state update
+	std::chrono::steady_clock::duration _maxStateCommitLatency { 0 };
+
+	// The result of the last execution, shared with chained instances
+	Result _result { &_memoryResource };
+	// The set point of array instances, in the form accepted by the write handles. The write handles only accept a
+	// plain std::vector, so this cannot be allocated from the memory resource. It is allocated once by realize().
+	std::vector<double> _setpointBuffer;
+
 	///////////////////////////////////////////////////////
 	// Input and outputs of the microservice
 
 	// Some random inputs
-	Input _left;
-	Input _right;
+	Input _left { &_memoryResource };
+	Input _right { &_memoryResource };
+
+	// Some random outputs. The set point can fan out to many targets, and is optional if the instance is only used
+	// as input for other instances.
+	Output _setpoint { &_memoryResource };
+	Output _safe { &_memoryResource };
+
+	// The input that tells us whether we are safe. If this is not configured, the safe output is read back if it is
+	// readable. Otherwise, the input remains empty, and the safe state is assumed once the safe output was written.
+	Input _isSafe { &_memoryResource };
+	// Whether the input that tells us whether we are safe was configured
+	bool _isSafeLoaded { false };
+	// Whether the safe output was set since it was last cleared, so that it is only cleared once after a suspension
+	bool _safeWritten { false };
 
-	// Some random outputs
-	Output _setpoint;
-	Output _safe;
-
-	// The input that tells us whether we are safe
-	Input _isSafe;
+	///////////////////////////////////////////////////////
+	// Suspend handling
+
+	// The name of the suspend group, or an empty string for none
+	std::string _suspendGroupName;
+	// The suspend group, if any
+	std::shared_ptr<SuspendGroup> _suspendGroup;
+	// Our index within the suspend group
+	std::size_t _suspendGroupIndex { 0 };
+	// The time after which we give up trying to get into a safe state
+	std::chrono::milliseconds _suspendTimeout { kDefaultSuspendTimeout };
+	// The time stamp of the cycle we started suspending in, or std::nullopt if we are not suspending
+	std::optional<std::chrono::system_clock::time_point> _suspendStart;
+	// The time it took to suspend the last time
+	std::chrono::system_clock::duration _suspendDuration { 0 };
 };
 
 } // namespace xentara::samples::simpleMicroservice
\ No newline at end of file
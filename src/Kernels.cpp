@@ -0,0 +1,125 @@
+// Copyright (c) embedded ocean GmbH
+#include "Kernels.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <stdexcept>
+
+namespace xentara::samples::simpleMicroservice::kernels
+{
+
+using namespace std::literals;
+
+namespace
+{
+
+// Applies a function element-wise, broadcasting inputs that contain a single element. Each case uses a separate,
+// branch-free loop over contiguous memory, so that the compiler can turn it into SIMD instructions.
+template <typename Function>
+auto transform(std::span<const double> left, std::span<const double> right, std::span<double> result, Function function)
+	-> void
+{
+	const auto size = result.size();
+	auto *const output = result.data();
+
+	if (left.size() == size && right.size() == size)
+	{
+		const auto *const leftData = left.data();
+		const auto *const rightData = right.data();
+		for (std::size_t index = 0; index < size; ++index)
+		{
+			output[index] = function(leftData[index], rightData[index]);
+		}
+	}
+	else if (left.size() == size && right.size() == 1)
+	{
+		const auto *const leftData = left.data();
+		const auto rightValue = right.front();
+		for (std::size_t index = 0; index < size; ++index)
+		{
+			output[index] = function(leftData[index], rightValue);
+		}
+	}
+	else if (left.size() == 1 && right.size() == size)
+	{
+		const auto leftValue = left.front();
+		const auto *const rightData = right.data();
+		for (std::size_t index = 0; index < size; ++index)
+		{
+			output[index] = function(leftValue, rightData[index]);
+		}
+	}
+	else
+	{
+		throw std::runtime_error(std::format(
+			"the left input has {} elements and the right input has {} elements, but {} were expected",
+			left.size(),
+			right.size(),
+			size));
+	}
+}
+
+} // namespace
+
+auto parseOperation(std::string_view name) noexcept -> std::optional<Operation>
+{
+	if (name == "max"sv)
+	{
+		return Operation::Max;
+	}
+	else if (name == "min"sv)
+	{
+		return Operation::Min;
+	}
+	else if (name == "add"sv)
+	{
+		return Operation::Add;
+	}
+	else if (name == "scale"sv)
+	{
+		return Operation::Scale;
+	}
+
+	return std::nullopt;
+}
+
+auto operationName(Operation operation) noexcept -> std::string_view
+{
+	switch (operation)
+	{
+	case Operation::Max:
+		return "max"sv;
+	case Operation::Min:
+		return "min"sv;
+	case Operation::Add:
+		return "add"sv;
+	case Operation::Scale:
+		return "scale"sv;
+	}
+
+	return "unknown"sv;
+}
+
+auto apply(Operation operation, std::span<const double> left, std::span<const double> right, std::span<double> result)
+	-> void
+{
+	// Select the loop outside of the element loop, so the loop bodies stay free of branches
+	switch (operation)
+	{
+	case Operation::Max:
+		transform(left, right, result, [](double l, double r) { return std::max(l, r); });
+		break;
+	case Operation::Min:
+		transform(left, right, result, [](double l, double r) { return std::min(l, r); });
+		break;
+	case Operation::Add:
+		transform(left, right, result, [](double l, double r) { return l + r; });
+		break;
+	case Operation::Scale:
+		transform(left, right, result, [](double l, double r) { return l * r; });
+		break;
+	}
+}
+
+} // namespace xentara::samples::simpleMicroservice::kernels
@@ -0,0 +1,38 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string_view>
+
+// Contains the computation kernels of the microservice
+namespace xentara::samples::simpleMicroservice::kernels
+{
+
+// The operations the microservice can perform
+enum class Operation
+{
+	// The maximum of the two inputs
+	Max,
+	// The minimum of the two inputs
+	Min,
+	// The sum of the two inputs
+	Add,
+	// The left input multiplied by the right input
+	Scale
+};
+
+// Parses the name of an operation as it appears in the model.json file. Returns std::nullopt if the name is unknown.
+auto parseOperation(std::string_view name) noexcept -> std::optional<Operation>;
+
+// Gets the name of an operation as it appears in the model.json file
+auto operationName(Operation operation) noexcept -> std::string_view;
+
+// Applies an operation element-wise to two arrays, writing the result into a preallocated buffer. Scalar values are
+// passed as arrays with a single element. Either input may also contain a single element, which is then applied to all
+// elements of the other input. The loops are written so that the compiler can vectorize them. Throws an exception if
+// the sizes do not match.
+auto apply(Operation operation, std::span<const double> left, std::span<const double> right, std::span<double> result)
+	-> void;
+
+} // namespace xentara::samples::simpleMicroservice::kernels
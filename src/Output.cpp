@@ -3,6 +3,8 @@
 
 #include <xentara/data/Quality.hpp>
 #include <xentara/model/Attribute.hpp>
+#include <xentara/utils/json/decoder/Array.hpp>
+#include <xentara/utils/json/decoder/Errors.hpp>
 
 #include <format>
 #include <functional>
@@ -14,27 +16,57 @@ namespace xentara::samples::simpleMicroservice
 {
 
 auto Output::load(utils::json::decoder::Value &value, config::Context &context) -> void
+{
+	// A single reference
+	if (!value.isArray())
+	{
+		loadElement(value, context);
+		return;
+	}
+
+	// An array of references, for fanning out a single value to many targets
+	for (auto &&item : value.asArray())
+	{
+		loadElement(item, context);
+	}
+
+	// Make sure we got at least one
+	if (_elements.empty())
+	{
+		utils::json::decoder::throwWithLocation(value, std::runtime_error("empty output element list"));
+	}
+}
+
+auto Output::loadElement(utils::json::decoder::Value &value, config::Context &context) -> void
 {
 	// Just submit a request
-	context.resolve<model::Element>(value, std::ref(_element));
+	context.resolve<model::Element>(value, std::ref(_elements.emplace_back()));
 }
 
 auto Output::prepare() -> void
 {
-	// Make sure the element was actually loaded
-	auto element = _element.lock();
-	if (!element)
+	_targets.clear();
+	_targets.reserve(_elements.size());
+
+	for (const auto &weakElement : _elements)
 	{
-		return;
-	}
+		// Make sure the element was actually loaded
+		auto element = weakElement.lock();
+		if (!element)
+		{
+			continue;
+		}
 
-	// Resolve the handle
-	_value = writeHandle(*element, model::Attribute::kValue.name());
+		// Resolve the handle
+		auto handle = writeHandle(*element, model::Attribute::kValue.name());
 
-	// Make sure the value is not read only
-	if (_value == data::WriteHandle::Error::ReadOnly)
-	{
-		throw std::runtime_error(std::format(R"(the value of element "{}" is read only )", *element));
+		// Make sure the value is not read only
+		if (handle == data::WriteHandle::Error::ReadOnly)
+		{
+			throw std::runtime_error(std::format(R"(the value of element "{}" is read only )", *element));
+		}
+
+		_targets.emplace_back(std::cref(weakElement), std::move(handle));
 	}
 }
 
@@ -52,10 +84,10 @@ auto Output::writeHandle(model::Element &element, std::string_view attributeName
 	return handle;
 }
 
-auto Output::elementName() const -> std::string
+auto Output::elementName(const std::weak_ptr<model::Element> &weakElement) const -> std::string
 {
 	// Get the element
-	auto element = _element.lock();
+	auto element = weakElement.lock();
 	if (!element)
 	{
 		return "output"s;
@@ -64,9 +96,9 @@ auto Output::elementName() const -> std::string
 	return element->primaryKey();
 }
 
-auto Output::handleWriteError(std::error_code error) -> void
+auto Output::handleWriteError(const Target &target, std::error_code error) -> void
 {
-	throw std::system_error(error, std::format("could not write {}", elementName()));
+	throw std::system_error(error, std::format("could not write {}", elementName(target._element)));
 }
 
-} // namespace xentara::samples::simpleMicroservice
\ No newline at end of file
+} // namespace xentara::samples::simpleMicroservice
@@ -6,64 +6,120 @@
 #include <xentara/model/Element.hpp>
 #include <xentara/utils/json/decoder/Value.hpp>
 
+#include <list>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <new>
+#include <vector>
 
 namespace xentara::samples::simpleMicroservice
 {
 
-// A single output of the microservice
+// A single output of the microservice. An output can fan out to more than one target element.
 class Output final
 {
 public:
-	// Loads the output from a configuration value
+	// Creates an output that allocates its internal structures from the given memory resource
+	explicit Output(std::pmr::memory_resource *memoryResource = std::pmr::get_default_resource()) :
+		_elements(memoryResource), _targets(memoryResource)
+	{
+	}
+
+	// Loads the output from a configuration value. The value can either be a single element reference, or an
+	// array of element references.
 	auto load(utils::json::decoder::Value &value, config::Context &context) -> void;
 
 	// Prepares the output
 	auto prepare() -> void;
 
-	// Writes the value as a certain type. Throws an exception on error.
+	// Writes the value as a certain type to all targets, one write per target. Throws an exception on error.
 	template <typename Type>
-	auto write(Type &&value) -> void;
+	auto write(const Type &value) -> void;
 
-	// Writes the value as a certain type without throwing any errors.
+	// Writes the value as a certain type to all targets without throwing any errors. Returns the first error.
 	template <typename Type>
-	auto write(Type &&value, std::nothrow_t) -> std::error_code;
+	auto write(const Type &value, std::nothrow_t) -> std::error_code;
+
+	// Gets the first target element, or an empty pointer if there is none
+	auto firstElement() const -> std::weak_ptr<model::Element>
+	{
+		return _elements.empty() ? std::weak_ptr<model::Element>() : _elements.front();
+	}
+
+	// Determines whether the output has any targets
+	auto empty() const noexcept -> bool
+	{
+		return _elements.empty();
+	}
 
 private:
+	// A single target of the output
+	struct Target final
+	{
+		// The element
+		std::reference_wrapper<const std::weak_ptr<model::Element>> _element;
+		// The write handle for the value
+		data::WriteHandle _value;
+	};
+
+	// Loads a single element reference
+	auto loadElement(utils::json::decoder::Value &value, config::Context &context) -> void;
+
 	// Gets a write handle
 	auto writeHandle(model::Element &element, std::string_view attributeName) -> data::WriteHandle;
 
-	// Gets a name for the element for use in error messages
-	auto elementName() const -> std::string;
-	
+	// Gets a name for an element for use in error messages
+	auto elementName(const std::weak_ptr<model::Element> &element) const -> std::string;
+
 	// Handles a write error. Always throws an exception.
-	[[noreturn]] auto handleWriteError(std::error_code error) -> void;
+	[[noreturn]] auto handleWriteError(const Target &target, std::error_code error) -> void;
 
-	// The element
-	std::weak_ptr<model::Element> _element;
+	// The elements. This is a list, so that the references handed to the config context remain valid while loading.
+	std::pmr::list<std::weak_ptr<model::Element>> _elements;
 
-	// The write handle for the value
-	data::WriteHandle _value;
+	// The targets, in a contiguous array so they can be iterated quickly
+	std::pmr::vector<Target> _targets;
 };
 
 template <typename Type>
-auto Output::write(Type &&value) -> void
+auto Output::write(const Type &value) -> void
 {
-	// Try to read the value
-	const auto error = _value.write(std::forward<Type>(value));
+	// Write all the targets one after the other, remembering the first one that failed
+	const Target *failedTarget = nullptr;
+	std::error_code firstError;
+	for (auto &&target : _targets)
+	{
+		const auto error = target._value.write(value);
+		if (error && !firstError)
+		{
+			failedTarget = &target;
+			firstError = error;
+		}
+	}
+
 	// Handles errors
-	if (error)
+	if (failedTarget)
 	{
-		handleWriteError(error);
+		handleWriteError(*failedTarget, firstError);
 	}
 }
 
 template <typename Type>
-auto Output::write(Type &&value, std::nothrow_t) -> std::error_code
+auto Output::write(const Type &value, std::nothrow_t) -> std::error_code
 {
-	return _value.write(std::forward<Type>(value));
+	// Write all the targets, even if some of them fail
+	std::error_code firstError;
+	for (auto &&target : _targets)
+	{
+		const auto error = target._value.write(value);
+		if (error && !firstError)
+		{
+			firstError = error;
+		}
+	}
+
+	return firstError;
 }
 
-} // namespace xentara::samples::simpleMicroservice
\ No newline at end of file
+} // namespace xentara::samples::simpleMicroservice
@@ -0,0 +1,117 @@
+// Copyright (c) embedded ocean GmbH
+#include "ParameterWatcher.hpp"
+
+#include "Instance.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <system_error>
+#include <utility>
+
+namespace xentara::samples::simpleMicroservice
+{
+
+auto ParameterWatcher::start() -> void
+{
+	std::scoped_lock lock { _mutex };
+
+	if (!_thread.joinable())
+	{
+		_thread = std::jthread([this](std::stop_token stopToken) { run(stopToken); });
+	}
+}
+
+auto ParameterWatcher::stop() -> void
+{
+	// Take the thread out under the lock, but join it without the lock, as the thread needs it to finish its poll
+	std::jthread thread;
+	{
+		std::scoped_lock lock { _mutex };
+		thread = std::move(_thread);
+	}
+	thread.request_stop();
+}
+
+auto ParameterWatcher::add(Instance &instance,
+	const std::filesystem::path &path,
+	const Parameters &defaults,
+	std::optional<std::filesystem::file_time_type> lastWriteTime) -> void
+{
+	std::scoped_lock lock { _mutex };
+
+	_entries.push_back({ std::ref(instance), path, defaults, instance._parameters, lastWriteTime });
+}
+
+auto ParameterWatcher::remove(const Instance &instance) -> void
+{
+	std::scoped_lock lock { _mutex };
+
+	std::erase_if(_entries, [&](const Entry &entry) { return &entry._instance.get() == &instance; });
+}
+
+auto ParameterWatcher::run(std::stop_token stopToken) -> void
+{
+	std::mutex sleepMutex;
+	std::condition_variable_any sleepCondition;
+
+	while (!stopToken.stop_requested())
+	{
+		// Check all the files
+		{
+			std::scoped_lock lock { _mutex };
+			for (auto &&entry : _entries)
+			{
+				check(entry);
+			}
+		}
+
+		// Wait for the next poll, or until we are stopped
+		std::unique_lock sleepLock { sleepMutex };
+		sleepCondition.wait_for(sleepLock, stopToken, kPollInterval, [] { return false; });
+	}
+}
+
+auto ParameterWatcher::check(Entry &entry) -> void
+{
+	// Skip files that have not been modified
+	std::error_code error;
+	const auto lastWriteTime = std::filesystem::last_write_time(entry._path, error);
+	if (error || lastWriteTime == entry._lastWriteTime)
+	{
+		return;
+	}
+	entry._lastWriteTime = lastWriteTime;
+
+	// Read and validate the new parameters
+	auto &instance = entry._instance.get();
+	Parameters parameters;
+	try
+	{
+		std::ifstream stream(entry._path);
+		if (!stream)
+		{
+			throw std::runtime_error("could not open parameter file");
+		}
+		parameters = parseParameters(stream, entry._defaults);
+	}
+	catch (...)
+	{
+		// Keep the current parameters
+		instance._parameterReloadErrors.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	// Leave the instance alone if nothing changed
+	if (parameters == entry._current)
+	{
+		return;
+	}
+
+	// Hand the new parameters to the instance
+	entry._current = parameters;
+	instance.publishParameters(parameters);
+}
+
+} // namespace xentara::samples::simpleMicroservice
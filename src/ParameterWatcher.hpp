@@ -0,0 +1,83 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include "Parameters.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace xentara::samples::simpleMicroservice
+{
+
+class Instance;
+
+// Watches the parameter files of microservice instances, and hands changed parameters to the instances.
+//
+// The files are polled on a background thread owned by the skill. Parameter files are only read and parsed on that
+// thread, and the instance is only notified if the file was modified and the parameters actually changed, so that the
+// execution of the instances is never delayed by a reload.
+class ParameterWatcher final
+{
+public:
+	// Stops the background thread
+	~ParameterWatcher()
+	{
+		stop();
+	}
+
+	// Starts the background thread, if it is not running yet
+	auto start() -> void;
+
+	// Stops the background thread
+	auto stop() -> void;
+
+	// Starts watching the parameter file of an instance. The defaults are used for all parameters missing from the file.
+	// The modification time must have been determined before the instance read the file, so that changes made while
+	// the instance was reading the file are not lost.
+	auto add(Instance &instance,
+		const std::filesystem::path &path,
+		const Parameters &defaults,
+		std::optional<std::filesystem::file_time_type> lastWriteTime) -> void;
+
+	// Stops watching the parameter file of an instance
+	auto remove(const Instance &instance) -> void;
+
+private:
+	// The interval at which the files are checked
+	static constexpr std::chrono::seconds kPollInterval { 1 };
+
+	// A watched parameter file
+	struct Entry final
+	{
+		// The instance
+		std::reference_wrapper<Instance> _instance;
+		// The file
+		std::filesystem::path _path;
+		// The parameters used for parameters missing from the file
+		Parameters _defaults;
+		// The parameters last handed to the instance
+		Parameters _current;
+		// The modification time of the file when it was last checked
+		std::optional<std::filesystem::file_time_type> _lastWriteTime;
+	};
+
+	// Polls the files until stopped
+	auto run(std::stop_token stopToken) -> void;
+
+	// Checks a single file for changes. Must be called with the mutex locked.
+	auto check(Entry &entry) -> void;
+
+	// The mutex protecting the entries
+	std::mutex _mutex;
+	// The watched files
+	std::vector<Entry> _entries;
+
+	// The polling thread. This must come last, so that it is stopped before the entries are destroyed.
+	std::jthread _thread;
+};
+
+} // namespace xentara::samples::simpleMicroservice
@@ -0,0 +1,158 @@
+// Copyright (c) embedded ocean GmbH
+#include "Parameters.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace xentara::samples::simpleMicroservice
+{
+
+using namespace std::literals;
+
+namespace
+{
+
+// Removes leading and trailing white space
+auto trim(std::string_view text) -> std::string_view
+{
+	constexpr auto kWhiteSpace = " \t\r\n"sv;
+
+	const auto first = text.find_first_not_of(kWhiteSpace);
+	if (first == std::string_view::npos)
+	{
+		return {};
+	}
+	const auto last = text.find_last_not_of(kWhiteSpace);
+
+	return text.substr(first, last - first + 1);
+}
+
+// Parses an operation. Throws an exception on error.
+auto parseOperation(std::string_view value, std::size_t lineNumber) -> kernels::Operation
+{
+	const auto operation = kernels::parseOperation(value);
+	if (!operation)
+	{
+		throw std::runtime_error(std::format(
+			R"(line {}: unknown operation "{}", must be "max", "min", "add", or "scale")", lineNumber, value));
+	}
+
+	return *operation;
+}
+
+// Parses a number. Throws an exception on error.
+auto parseNumber(std::string_view value, std::size_t lineNumber) -> double
+{
+	double number {};
+	const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+	if (error != std::errc() || end != value.data() + value.size())
+	{
+		throw std::runtime_error(std::format(R"(line {}: "{}" is not a valid number)", lineNumber, value));
+	}
+
+	return number;
+}
+
+// Parses a switch. Throws an exception on error.
+auto parseSwitch(std::string_view value, std::size_t lineNumber) -> bool
+{
+	if (value == "on"sv)
+	{
+		return true;
+	}
+	else if (value == "off"sv)
+	{
+		return false;
+	}
+
+	throw std::runtime_error(
+		std::format(R"(line {}: "{}" is not a valid switch, must be "on" or "off")", lineNumber, value));
+}
+
+// Parses a counter. Throws an exception on error.
+auto parseCounter(std::string_view value, std::size_t lineNumber) -> std::uint64_t
+{
+	std::uint64_t counter {};
+	const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), counter);
+	if (error != std::errc() || end != value.data() + value.size())
+	{
+		throw std::runtime_error(std::format(R"(line {}: "{}" is not a valid counter)", lineNumber, value));
+	}
+
+	return counter;
+}
+
+} // namespace
+
+auto parseParameters(std::istream &stream, const Parameters &defaults) -> Parameters
+{
+	Parameters parameters = defaults;
+
+	std::string line;
+	for (std::size_t lineNumber = 1; std::getline(stream, line); ++lineNumber)
+	{
+		// Skip empty lines and comments
+		const auto text = trim(line);
+		if (text.empty() || text.front() == '#')
+		{
+			continue;
+		}
+
+		// Split into name and value
+		const auto separator = text.find('=');
+		if (separator == std::string_view::npos)
+		{
+			throw std::runtime_error(std::format(R"(line {}: expected "name = value")", lineNumber));
+		}
+		const auto name = trim(text.substr(0, separator));
+		const auto value = trim(text.substr(separator + 1));
+
+		// Handle the parameter
+		if (name == "operation"sv)
+		{
+			parameters._operation = parseOperation(value, lineNumber);
+		}
+		else if (name == "shadowOperation"sv)
+		{
+			if (value == "none"sv)
+			{
+				parameters._shadowOperation.reset();
+			}
+			else
+			{
+				parameters._shadowOperation = parseOperation(value, lineNumber);
+			}
+		}
+		else if (name == "shadowTolerance"sv)
+		{
+			parameters._shadowTolerance = parseNumber(value, lineNumber);
+		}
+		else if (name == "trace"sv)
+		{
+			parameters._trace = parseSwitch(value, lineNumber);
+		}
+		else if (name == "traceDump"sv)
+		{
+			parameters._traceDump = parseCounter(value, lineNumber);
+		}
+		else
+		{
+			throw std::runtime_error(std::format(R"(line {}: unknown parameter "{}")", lineNumber, name));
+		}
+	}
+
+	// Check for read errors
+	if (stream.bad())
+	{
+		throw std::runtime_error("error reading parameter file");
+	}
+
+	return parameters;
+}
+
+} // namespace xentara::samples::simpleMicroservice
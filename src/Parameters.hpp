@@ -0,0 +1,36 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include "Kernels.hpp"
+
+#include <cstdint>
+#include <istream>
+#include <optional>
+
+namespace xentara::samples::simpleMicroservice
+{
+
+// The parameters of a microservice instance that can be changed while the instance is running
+struct Parameters final
+{
+	// The operation used to compute the set point
+	kernels::Operation _operation { kernels::Operation::Max };
+	// The operation of the shadow kernel, or std::nullopt if there is no shadow kernel
+	std::optional<kernels::Operation> _shadowOperation;
+	// The maximum deviation between the shadow kernel and the primary kernel that is not considered a divergence
+	double _shadowTolerance { 0 };
+	// Whether the execution is traced. This has no effect if no trace file was configured.
+	bool _trace { false };
+	// A counter that requests a dump of the trace whenever it changes
+	std::uint64_t _traceDump { 0 };
+
+	// Compares two sets of parameters
+	auto operator==(const Parameters &other) const -> bool = default;
+};
+
+// Parses a parameter file. The file contains lines of the form "name = value". Empty lines and lines starting with "#"
+// are ignored. Parameters not contained in the file are taken from the defaults. Throws an exception if the file is
+// invalid.
+auto parseParameters(std::istream &stream, const Parameters &defaults) -> Parameters;
+
+} // namespace xentara::samples::simpleMicroservice
@@ -14,7 +14,7 @@ auto Skill::createElement(const skill::Element::Class &elementClass, skill::Elem
 {
 	if (&elementClass == &Instance::Class::instance())
 	{
-		return factory.makeShared<Instance>();
+		return factory.makeShared<Instance>(_traceWriter, _parameterWatcher);
 	}
 
 	return nullptr;
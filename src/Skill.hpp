@@ -2,6 +2,8 @@
 #pragma once
 
 #include "Instance.hpp"
+#include "ParameterWatcher.hpp"
+#include "Trace.hpp"
 
 #include <xentara/skill/Skill.hpp>
 #include <xentara/utils/core/Uuid.hpp>
@@ -32,6 +34,11 @@ private:
 
 	// The skill class object
 	static Class _class;
+
+	// The writer for the trace dumps of all instances
+	trace::Writer _traceWriter;
+	// The watcher for the parameter files of all instances
+	ParameterWatcher _parameterWatcher;
 };
 
 } // namespace xentara::samples::simpleMicroservice
\ No newline at end of file
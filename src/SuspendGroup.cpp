@@ -0,0 +1,117 @@
+// Copyright (c) embedded ocean GmbH
+#include "SuspendGroup.hpp"
+
+#include "Instance.hpp"
+
+#include <functional>
+#include <map>
+#include <stdexcept>
+
+namespace xentara::samples::simpleMicroservice
+{
+
+auto SuspendGroup::named(std::string_view name) -> std::shared_ptr<SuspendGroup>
+{
+	// The registry of all groups. The groups are owned by their members, so they go away with the model.
+	static std::mutex registryMutex;
+	static std::map<std::string, std::weak_ptr<SuspendGroup>, std::less<>> registry;
+
+	std::scoped_lock lock { registryMutex };
+
+	// Use the existing group, if there is one
+	auto &entry = registry[std::string(name)];
+	if (auto group = entry.lock())
+	{
+		return group;
+	}
+
+	// Create a new group
+	auto group = std::make_shared<SuspendGroup>();
+	entry = group;
+	return group;
+}
+
+auto SuspendGroup::add(Instance &instance) -> std::size_t
+{
+	std::scoped_lock lock { _mutex };
+
+	_members.push_back({ std::ref(instance) });
+	return _members.size() - 1;
+}
+
+auto SuspendGroup::suspend(std::size_t memberIndex, std::chrono::system_clock::time_point timeStamp)
+	-> std::error_code
+{
+	std::unique_lock lock { _mutex };
+	auto &instance = _members.at(memberIndex)._instance.get();
+	lock.unlock();
+
+	// Write the safe output without holding the lock, so other members are not blocked by the write
+	const auto error = instance.safe(timeStamp);
+
+	lock.lock();
+
+	// The member is now suspending
+	auto &member = _members.at(memberIndex);
+	member._suspending = true;
+	member._safe = false;
+	member._checkError.reset();
+
+	// Force a new check, now that there is a new member to check
+	_checkTimeStamp = std::chrono::system_clock::time_point::min();
+
+	return error;
+}
+
+auto SuspendGroup::resume(std::size_t memberIndex) -> void
+{
+	std::scoped_lock lock { _mutex };
+
+	auto &member = _members.at(memberIndex);
+	member._suspending = false;
+	member._safe = false;
+	member._checkError.reset();
+}
+
+auto SuspendGroup::isSafe(std::size_t memberIndex, std::chrono::system_clock::time_point timeStamp) -> bool
+{
+	std::scoped_lock lock { _mutex };
+
+	// Check all members that are not yet known to be safe, if no other member has done so in this cycle
+	if (_checkTimeStamp != timeStamp)
+	{
+		_checkTimeStamp = timeStamp;
+
+		for (auto &&member : _members)
+		{
+			if (!member._suspending || member._safe || member._checkError)
+			{
+				continue;
+			}
+
+			try
+			{
+				member._safe = member._instance.get().isSafe();
+			}
+			catch (const std::exception &exception)
+			{
+				member._checkError = exception.what();
+			}
+			catch (...)
+			{
+				member._checkError = "unknown error";
+			}
+		}
+	}
+
+	// Report the result for the requested member
+	const auto &result = _members.at(memberIndex);
+	if (result._checkError)
+	{
+		throw std::runtime_error(*result._checkError);
+	}
+
+	return result._safe;
+}
+
+} // namespace xentara::samples::simpleMicroservice
@@ -0,0 +1,70 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace xentara::samples::simpleMicroservice
+{
+
+class Instance;
+
+// A group of microservice instances that are suspended together.
+//
+// Each member writes its own safe output when its own task is suspended, so that members that are still operational
+// are never put into the safe state. The writes are not batched. Only the check for the safe state is shared: the
+// first member that checks for completion in a cycle checks all members that are being suspended and are not yet safe,
+// and all other members just pick up the results.
+class SuspendGroup final
+{
+public:
+	// Gets the group with the given name, creating it if it does not exist yet
+	static auto named(std::string_view name) -> std::shared_ptr<SuspendGroup>;
+
+	// Adds an instance to the group. Returns the index of the new member.
+	auto add(Instance &instance) -> std::size_t;
+
+	// Suspends a member. This must be called when the task of the member has entered the post-operational stage.
+	// Writes the safe output of the member, and returns the error writing it, if any.
+	auto suspend(std::size_t memberIndex, std::chrono::system_clock::time_point timeStamp) -> std::error_code;
+
+	// Marks a member as operational again
+	auto resume(std::size_t memberIndex) -> void;
+
+	// Checks whether a suspending member is safe. Checks all suspending members if this has not been done yet in this
+	// cycle. Throws an exception if the safe state of the member could not be determined.
+	auto isSafe(std::size_t memberIndex, std::chrono::system_clock::time_point timeStamp) -> bool;
+
+private:
+	// A member of the group
+	struct Member final
+	{
+		// The instance
+		std::reference_wrapper<Instance> _instance;
+		// Whether the task of the instance has entered the post-operational stage and written its safe output
+		bool _suspending { false };
+		// Whether the instance was confirmed to be safe
+		bool _safe { false };
+		// The error message if the safe state could not be determined
+		std::optional<std::string> _checkError {};
+	};
+
+	// The mutex protecting the members
+	std::mutex _mutex;
+
+	// The members
+	std::vector<Member> _members;
+
+	// The time stamp of the cycle the members were last checked in
+	std::chrono::system_clock::time_point _checkTimeStamp { std::chrono::system_clock::time_point::min() };
+};
+
+} // namespace xentara::samples::simpleMicroservice
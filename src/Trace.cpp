@@ -0,0 +1,376 @@
+// Copyright (c) embedded ocean GmbH
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace xentara::samples::simpleMicroservice::trace
+{
+
+using namespace std::literals;
+
+namespace detail
+{
+
+std::atomic<bool> gEnabled { false };
+
+} // namespace detail
+
+namespace
+{
+
+// A single recorded span
+struct Record final
+{
+	// The name of the element the span belongs to
+	NameId _name;
+	// The phase
+	Phase _phase;
+	// The start time stamp in nanoseconds
+	std::int64_t _start;
+	// The end time stamp in nanoseconds
+	std::int64_t _end;
+};
+
+// The number of records in the ring buffer of each thread. This must be a power of two.
+constexpr std::size_t kCapacity = 16384;
+static_assert((kCapacity & (kCapacity - 1)) == 0, "the trace buffer capacity must be a power of two");
+
+// The next thread index to assign
+std::atomic<std::uint32_t> gNextThreadIndex { 1 };
+
+// The mutex protecting the number of users
+std::mutex gUsersMutex;
+// The number of users that enabled tracing
+std::size_t gUsers { 0 };
+
+// The mutex protecting the interned names
+std::mutex gNamesMutex;
+// The interned names, indexed by ID
+std::vector<std::string> gNames { "unknown"s };
+// The IDs of the interned names
+std::map<std::string, NameId, std::less<>> gNameIds;
+
+} // namespace
+
+namespace detail
+{
+
+// A copy of the ring buffer of a thread that is waiting to be written
+struct Snapshot final
+{
+	// The records. This is swapped with the ring buffer of the thread when a dump is requested.
+	std::unique_ptr<std::array<Record, kCapacity>> _records { std::make_unique<std::array<Record, kCapacity>>() };
+	// The total number of records that were written to the records
+	std::uint64_t _count { 0 };
+	// The index of the thread, used as thread ID in the trace
+	std::uint32_t _threadIndex { 0 };
+	// The file to write to
+	std::shared_ptr<const std::filesystem::path> _path;
+	// The next pending snapshot
+	Snapshot *_next { nullptr };
+	// Whether the snapshot is waiting to be written
+	std::atomic<bool> _pending { false };
+};
+
+} // namespace detail
+
+namespace
+{
+
+// The ring buffer of a thread
+struct ThreadBuffer final
+{
+	// Waits until the last dump was written, as the writer still accesses the snapshot until then
+	~ThreadBuffer()
+	{
+		_snapshot._pending.wait(true, std::memory_order_acquire);
+	}
+
+	// The records
+	std::unique_ptr<std::array<Record, kCapacity>> _records { std::make_unique<std::array<Record, kCapacity>>() };
+	// The total number of records ever written
+	std::uint64_t _count { 0 };
+	// The index of the thread, used as thread ID in the trace
+	std::uint32_t _threadIndex { gNextThreadIndex.fetch_add(1, std::memory_order_relaxed) };
+	// The snapshot handed to the writer
+	detail::Snapshot _snapshot;
+};
+
+// Gets the buffer of the current thread
+auto threadBuffer() -> ThreadBuffer &
+{
+	thread_local ThreadBuffer buffer;
+	return buffer;
+}
+
+// Gets the name of a phase
+auto phaseName(Phase phase) noexcept -> std::string_view
+{
+	switch (phase)
+	{
+	case Phase::Execute:
+		return "execute"sv;
+	case Phase::CacheLookup:
+		return "cacheLookup"sv;
+	case Phase::QualityRead:
+		return "qualityRead"sv;
+	case Phase::ValueRead:
+		return "valueRead"sv;
+	case Phase::Compute:
+		return "compute"sv;
+	case Phase::OutputWrite:
+		return "outputWrite"sv;
+	case Phase::UpdateState:
+		return "updateState"sv;
+	}
+
+	return "unknown"sv;
+}
+
+// Gets an interned name
+auto nameOf(NameId name) -> std::string
+{
+	std::scoped_lock lock { gNamesMutex };
+
+	return name < gNames.size() ? gNames[name] : gNames[kUnknownName];
+}
+
+// Escapes a string for use in JSON
+auto escapeJson(std::string_view text) -> std::string
+{
+	std::string result;
+	result.reserve(text.size());
+	for (const auto character : text)
+	{
+		switch (character)
+		{
+		case '"':
+			result += R"(\")"sv;
+			break;
+		case '\\':
+			result += R"(\\)"sv;
+			break;
+		default:
+			if (static_cast<unsigned char>(character) < 0x20)
+			{
+				std::format_to(std::back_inserter(result), "\\u{:04x}", static_cast<unsigned>(character));
+			}
+			else
+			{
+				result += character;
+			}
+		}
+	}
+
+	return result;
+}
+
+// Writes a snapshot to its file in Chrome trace event format. Throws an exception on error.
+auto write(const detail::Snapshot &snapshot) -> void
+{
+	const auto &path = *snapshot._path;
+
+	// Open the file
+	std::ofstream stream(path, std::ios::out | std::ios::trunc);
+	if (!stream)
+	{
+		throw std::runtime_error(std::format(R"(could not open trace file "{}")", path.string()));
+	}
+
+	// Write the records from oldest to newest
+	stream << R"({"traceEvents":[)";
+	const auto first = snapshot._count > kCapacity ? snapshot._count - kCapacity : 0;
+	for (auto index = first; index < snapshot._count; ++index)
+	{
+		const auto &record = (*snapshot._records)[index & (kCapacity - 1)];
+
+		const auto elementName = escapeJson(nameOf(record._name));
+		stream << std::format(
+			R"({}{{"name":"{}","cat":"microservice","ph":"X","ts":{:.3f},"dur":{:.3f},"pid":1,"tid":{},"args":{{"element":"{}"}}}})",
+			index == first ? "" : ",",
+			phaseName(record._phase),
+			static_cast<double>(record._start) / 1000.0,
+			static_cast<double>(record._end - record._start) / 1000.0,
+			snapshot._threadIndex,
+			elementName);
+	}
+	stream << "]}\n";
+
+	// Check for errors
+	stream.close();
+	if (!stream)
+	{
+		throw std::runtime_error(std::format(R"(could not write trace file "{}")", path.string()));
+	}
+}
+
+} // namespace
+
+namespace detail
+{
+
+auto record(NameId name, Phase phase, std::int64_t start, std::int64_t end) noexcept -> void
+{
+	try
+	{
+		auto &buffer = threadBuffer();
+		(*buffer._records)[buffer._count & (kCapacity - 1)] = { name, phase, start, end };
+		++buffer._count;
+	}
+	catch (...)
+	{
+		// The buffer could not be allocated, so the span is lost
+	}
+}
+
+} // namespace detail
+
+auto internName(std::string_view name) -> NameId
+{
+	std::scoped_lock lock { gNamesMutex };
+
+	// Reuse the ID if the name is already known
+	if (const auto existing = gNameIds.find(name); existing != gNameIds.end())
+	{
+		return existing->second;
+	}
+
+	const auto id = static_cast<NameId>(gNames.size());
+	gNames.emplace_back(name);
+	gNameIds.emplace(name, id);
+
+	return id;
+}
+
+auto enable() -> void
+{
+	std::scoped_lock lock { gUsersMutex };
+
+	if (gUsers++ == 0)
+	{
+		detail::gEnabled.store(true, std::memory_order_relaxed);
+	}
+}
+
+auto disable() -> void
+{
+	std::scoped_lock lock { gUsersMutex };
+
+	if (gUsers > 0 && --gUsers == 0)
+	{
+		detail::gEnabled.store(false, std::memory_order_relaxed);
+	}
+}
+
+auto Writer::start() -> void
+{
+	std::scoped_lock lock { _mutex };
+
+	if (!_thread.joinable())
+	{
+		_thread = std::jthread([this](std::stop_token stopToken) { run(stopToken); });
+	}
+}
+
+auto Writer::stop() -> void
+{
+	// Take the thread out under the lock, so no new dumps are accepted, but join it without the lock, so it can
+	// finish writing
+	std::jthread thread;
+	{
+		std::scoped_lock lock { _mutex };
+		thread = std::move(_thread);
+	}
+	thread.request_stop();
+}
+
+auto Writer::dumpThread(std::shared_ptr<const std::filesystem::path> path) -> bool
+{
+	auto &buffer = threadBuffer();
+	auto &snapshot = buffer._snapshot;
+
+	// Skip the dump if the last one has not been written yet
+	if (snapshot._pending.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	std::scoped_lock lock { _mutex };
+
+	// Make sure we are running
+	if (!_thread.joinable())
+	{
+		return false;
+	}
+
+	// Swap the ring buffer with the spare one, so the thread can continue recording right away
+	std::swap(buffer._records, snapshot._records);
+	snapshot._count = std::exchange(buffer._count, 0);
+	snapshot._threadIndex = buffer._threadIndex;
+	snapshot._path = std::move(path);
+
+	// Add it to the pending dumps
+	snapshot._pending.store(true, std::memory_order_relaxed);
+	snapshot._next = _pending;
+	_pending = &snapshot;
+	_condition.notify_all();
+
+	return true;
+}
+
+auto Writer::run(std::stop_token stopToken) -> void
+{
+	std::unique_lock lock { _mutex };
+
+	while (true)
+	{
+		// Wait for dumps. If we are stopped, the remaining dumps are still written.
+		_condition.wait(lock, stopToken, [this] { return _pending != nullptr; });
+		if (!_pending)
+		{
+			break;
+		}
+
+		// Take all pending dumps, and write them without holding the lock
+		auto snapshot = std::exchange(_pending, nullptr);
+		lock.unlock();
+
+		while (snapshot)
+		{
+			// Get the next snapshot now, as the thread may reuse or destroy this one as soon as we are done
+			const auto next = snapshot->_next;
+
+			try
+			{
+				write(*snapshot);
+			}
+			catch (...)
+			{
+				// The trace is only a diagnostic aid, so errors writing it are ignored
+			}
+
+			snapshot->_path.reset();
+			snapshot->_pending.store(false, std::memory_order_release);
+			snapshot->_pending.notify_all();
+
+			snapshot = next;
+		}
+
+		lock.lock();
+	}
+}
+
+} // namespace xentara::samples::simpleMicroservice::trace
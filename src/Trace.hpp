@@ -0,0 +1,159 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+// Contains a low overhead tracing facility for the execution phases of the microservice.
+//
+// Each thread records the spans into its own preallocated ring buffer, so recording a span never locks or allocates
+// (except for the very first span recorded on a thread). The ring buffer of a thread can be handed to a background
+// writer, which writes it to a file in Chrome trace event format, which can be viewed using chrome://tracing or
+// https://ui.perfetto.dev.
+namespace xentara::samples::simpleMicroservice::trace
+{
+
+// The phases that are traced
+enum class Phase : std::uint8_t
+{
+	// The complete execution of a microservice instance in one cycle
+	Execute,
+	// Looking up an input in the input cache
+	CacheLookup,
+	// Reading the quality of an input
+	QualityRead,
+	// Reading the value of an input
+	ValueRead,
+	// Computing the set point
+	Compute,
+	// Writing the outputs
+	OutputWrite,
+	// Updating the state data block
+	UpdateState
+};
+
+// Identifies the name of the element a span belongs to. Spans store this instead of a pointer to the element, so that
+// they can be written after the element has been destroyed.
+using NameId = std::uint32_t;
+
+// The name ID used for spans that cannot be attributed to an element
+constexpr NameId kUnknownName = 0;
+
+// Gets the ID for a name. The same name always gets the same ID, and names are never removed, so IDs stay valid for
+// the lifetime of the process.
+auto internName(std::string_view name) -> NameId;
+
+namespace detail
+{
+
+// Whether tracing is enabled
+extern std::atomic<bool> gEnabled;
+
+// Gets the current time stamp for a span
+inline auto now() noexcept -> std::int64_t
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Records a span in the ring buffer of the current thread
+auto record(NameId name, Phase phase, std::int64_t start, std::int64_t end) noexcept -> void;
+
+// A copy of the ring buffer of a thread that is waiting to be written
+struct Snapshot;
+
+} // namespace detail
+
+// Determines whether tracing is enabled
+inline auto isEnabled() noexcept -> bool
+{
+	return detail::gEnabled.load(std::memory_order_relaxed);
+}
+
+// Enables tracing. Tracing stays enabled until disable() has been called once for every call to enable(), so that
+// different users of the tracing facility don't interfere with each other. This can be called at any time.
+auto enable() -> void;
+
+// Undoes a call to enable()
+auto disable() -> void;
+
+// Writes the ring buffers of threads to files on a background thread, so that the threads being traced are never
+// blocked by formatting or file I/O.
+class Writer final
+{
+public:
+	// Stops the background thread
+	~Writer()
+	{
+		stop();
+	}
+
+	// Starts the background thread, if it is not running yet
+	auto start() -> void;
+
+	// Stops the background thread after writing all pending dumps
+	auto stop() -> void;
+
+	// Hands the ring buffer of the current thread to the background thread, to be written to a file. The ring buffer
+	// is swapped with a preallocated spare buffer, so this takes constant time and does not allocate. Returns false if
+	// the writer is not running, or if the last dump of this thread has not been written yet.
+	auto dumpThread(std::shared_ptr<const std::filesystem::path> path) -> bool;
+
+private:
+	// Writes the dumps until stopped
+	auto run(std::stop_token stopToken) -> void;
+
+	// The mutex protecting the pending dumps
+	std::mutex _mutex;
+	// The condition signalled when dumps are added
+	std::condition_variable_any _condition;
+	// The pending dumps, as an intrusive list, so that adding a dump does not allocate
+	detail::Snapshot *_pending { nullptr };
+
+	// The background thread
+	std::jthread _thread;
+};
+
+// Records the span of a phase from construction to destruction. If tracing is disabled when the span is constructed,
+// the span costs a single relaxed load.
+class Span final
+{
+public:
+	// Starts a span for the element with the given name
+	Span(NameId name, Phase phase) noexcept :
+		_name(name), _phase(phase), _start(isEnabled() ? detail::now() : kDisabled)
+	{
+	}
+
+	// Ends the span
+	~Span()
+	{
+		if (_start != kDisabled)
+		{
+			detail::record(_name, _phase, _start, detail::now());
+		}
+	}
+
+	Span(const Span &) = delete;
+	auto operator=(const Span &) -> Span & = delete;
+
+private:
+	// The start value used if tracing is disabled
+	static constexpr std::int64_t kDisabled = -1;
+
+	// The name of the element the span belongs to
+	NameId _name;
+	// The phase
+	Phase _phase;
+	// The start time stamp, or kDisabled
+	std::int64_t _start;
+};
+
+} // namespace xentara::samples::simpleMicroservice::trace
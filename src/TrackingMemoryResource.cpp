@@ -0,0 +1,45 @@
+// Copyright (c) embedded ocean GmbH
+#include "TrackingMemoryResource.hpp"
+
+namespace xentara::samples::simpleMicroservice
+{
+
+auto TrackingMemoryResource::do_allocate(std::size_t bytes, std::size_t alignment) -> void *
+{
+	// Allocate the memory first, so we don't count failed allocations
+	auto pointer = _upstream->allocate(bytes, alignment);
+
+	// Update the counters
+	const auto total = _bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (_operational.load(std::memory_order_relaxed))
+	{
+		_operationalAllocations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Update the high water mark
+	auto highWaterMark = _highWaterMark.load(std::memory_order_relaxed);
+	while (total > highWaterMark &&
+		!_highWaterMark.compare_exchange_weak(highWaterMark, total, std::memory_order_relaxed))
+	{
+	}
+
+	return pointer;
+}
+
+auto TrackingMemoryResource::do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) -> void
+{
+	_upstream->deallocate(pointer, bytes, alignment);
+
+	// Update the counters
+	_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+	_allocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+auto TrackingMemoryResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept -> bool
+{
+	// Memory must always be returned to the resource that allocated it, so that the counters stay correct
+	return this == &other;
+}
+
+} // namespace xentara::samples::simpleMicroservice
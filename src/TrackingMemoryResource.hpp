@@ -0,0 +1,83 @@
+// Copyright (c) embedded ocean GmbH
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace xentara::samples::simpleMicroservice
+{
+
+// A memory resource that keeps track of the memory allocated through it.
+//
+// All allocations are forwarded to an upstream resource. The resource counts the bytes and blocks currently
+// allocated, as well as the high water mark, and the number of allocations that happened while operational.
+class TrackingMemoryResource final : public std::pmr::memory_resource
+{
+public:
+	// Creates a resource that allocates from the given upstream resource
+	explicit TrackingMemoryResource(
+		std::pmr::memory_resource *upstream = std::pmr::get_default_resource()) noexcept :
+		_upstream(upstream)
+	{
+	}
+
+	// Gets the number of bytes currently allocated
+	auto bytes() const noexcept -> std::uint64_t
+	{
+		return _bytes.load(std::memory_order_relaxed);
+	}
+
+	// Gets the number of blocks currently allocated
+	auto allocations() const noexcept -> std::uint64_t
+	{
+		return _allocations.load(std::memory_order_relaxed);
+	}
+
+	// Gets the highest number of bytes that were ever allocated at the same time
+	auto highWaterMark() const noexcept -> std::uint64_t
+	{
+		return _highWaterMark.load(std::memory_order_relaxed);
+	}
+
+	// Gets the number of allocations that were made while operational
+	auto operationalAllocations() const noexcept -> std::uint64_t
+	{
+		return _operationalAllocations.load(std::memory_order_relaxed);
+	}
+
+	// Sets whether the owner is operational. Any allocations made while operational are counted separately, as
+	// they indicate an allocation on the hot path.
+	auto setOperational(bool operational) noexcept -> void
+	{
+		_operational.store(operational, std::memory_order_relaxed);
+	}
+
+private:
+	///////////////////////////////////////////////////////
+	// Virtual overrides for std::pmr::memory_resource
+
+	auto do_allocate(std::size_t bytes, std::size_t alignment) -> void * final;
+
+	auto do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) -> void final;
+
+	auto do_is_equal(const std::pmr::memory_resource &other) const noexcept -> bool final;
+
+	// The upstream resource
+	std::pmr::memory_resource *_upstream;
+
+	// The number of bytes currently allocated
+	std::atomic<std::uint64_t> _bytes { 0 };
+	// The number of blocks currently allocated
+	std::atomic<std::uint64_t> _allocations { 0 };
+	// The highest number of bytes that were ever allocated at the same time
+	std::atomic<std::uint64_t> _highWaterMark { 0 };
+	// The number of allocations that were made while operational
+	std::atomic<std::uint64_t> _operationalAllocations { 0 };
+
+	// Whether the owner is operational
+	std::atomic<bool> _operational { false };
+};
+
+} // namespace xentara::samples::simpleMicroservice